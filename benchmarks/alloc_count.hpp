@@ -0,0 +1,55 @@
+#ifndef ALLOC_COUNT_HPP
+#define ALLOC_COUNT_HPP
+
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <cstdlib>
+#include <new>
+#include <stdint.h>
+
+/*******************************************************************************
+**                                  GLOBALS                                   **
+*******************************************************************************/
+// Number of calls to operator new since the start of the program
+static uint_fast64_t nb_allocs = 0;
+
+// Number of bytes allocated with operator new since the start of the program
+static uint_fast64_t nb_alloc_bytes = 0;
+
+/*******************************************************************************
+**                             ALLOCATION COUNTING                            **
+*******************************************************************************/
+/*
+** The global operators new and delete are replaced to count the allocations.
+** Replacements can't be inline, so this header must only be included by the
+** file that contains the main() of a benchmark
+*/
+void *operator new(std::size_t size)
+{
+    ++nb_allocs;
+    nb_alloc_bytes += size;
+    void *p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
+
+#endif // !ALLOC_COUNT_HPP
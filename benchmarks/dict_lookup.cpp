@@ -0,0 +1,71 @@
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "../src/json.hpp"
+
+/*******************************************************************************
+**                              DEFINES / MACROS                              **
+*******************************************************************************/
+// Number of lookups done for each dict size
+#define NB_LOOKUPS 4000000
+
+/*******************************************************************************
+**                                    MAIN                                    **
+*******************************************************************************/
+/**
+** \brief Measures the time of JSONDict::getItem on dicts of increasing sizes.
+**        The program is compiled twice by 'make bench-dict', once with a hash
+**        index on every dict and once without any, the crossover point is the
+**        first size from which the 'hash' times are lower than the 'linear'
+**        ones
+*/
+int main()
+{
+    static const uint_fast64_t sizes[] = { 1,  2,  4,  6,  8,   12,  16,
+                                           24, 32, 48, 64, 128, 1024 };
+
+    printf("%s (DICT_INDEX_MIN_SIZE=%llu)\n",
+           DICT_INDEX_MIN_SIZE <= 1 ? "hash" : "linear",
+           (unsigned long long)DICT_INDEX_MIN_SIZE);
+    printf("%8s %12s\n", "size", "ns/lookup");
+
+    uint_fast64_t found = 0;
+    for (uint_fast64_t size : sizes)
+    {
+        // Keys of realistic length that share a common prefix
+        JSONDict dict;
+        char **keys = new char *[size];
+        for (uint_fast64_t i = 0; i < size; ++i)
+        {
+            keys[i] = new char[32];
+            int len = snprintf(keys[i], 32, "property_name_%llu",
+                               (unsigned long long)i);
+            char *str = new char[len + 1];
+            memcpy(str, keys[i], len + 1);
+            dict.addItem(new String(str, len), Value());
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint_fast64_t i = 0; i < NB_LOOKUPS; ++i)
+        {
+            const char *key = keys[i % size];
+            found += dict.getItem(key, strlen(key)) != nullptr;
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        double ns = std::chrono::duration<double, std::nano>(end - start)
+                        .count();
+        printf("%8llu %12.2f\n", (unsigned long long)size, ns / NB_LOOKUPS);
+
+        for (uint_fast64_t i = 0; i < size; ++i)
+        {
+            delete[] keys[i];
+        }
+        delete[] keys;
+    }
+    return found == 0;
+}
@@ -0,0 +1,158 @@
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+
+#include "../src/key_table.hpp"
+#include "../src/parser.hpp"
+#include "alloc_count.hpp"
+
+/*******************************************************************************
+**                              DEFINES / MACROS                              **
+*******************************************************************************/
+// Number of records of the generated document
+#define NB_RECORDS 200000
+
+// Number of times each measure is repeated (the best time is kept)
+#define NB_RUNS 5
+
+/*******************************************************************************
+**                              LOCAL FUNCTIONS                               **
+*******************************************************************************/
+/**
+** \brief Generates an array of records that all have the same keys
+*/
+static std::string generate()
+{
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> real(0, 1e4);
+    char buff[256];
+    std::string s = "[";
+    for (uint_fast64_t i = 0; i < NB_RECORDS; ++i)
+    {
+        snprintf(buff, sizeof(buff),
+                 "{\"identifier\": %lu, \"display_name\": \"record %lu\", "
+                 "\"unit_price\": %.2f, \"is_available\": %s, "
+                 "\"warehouse_location\": {\"aisle_number\": %lu, "
+                 "\"shelf_number\": %lu}}%s",
+                 (unsigned long)i, (unsigned long)i, real(rng),
+                 rng() % 2 ? "true" : "false", (unsigned long)(rng() % 100),
+                 (unsigned long)(rng() % 100), i + 1 < NB_RECORDS ? ", " : "");
+        s += buff;
+    }
+    s += "]";
+    return s;
+}
+
+/**
+** \returns The sum of the shelf numbers of the records, found with the bytes
+**          of the keys
+*/
+static int_fast64_t sum_by_chars(JSONArray *records)
+{
+    int_fast64_t sum = 0;
+    uint_fast64_t size = records->getSize();
+    for (uint_fast64_t i = 0; i < size; ++i)
+    {
+        JSONDict *jd = records->getValueAt(i)->getDict();
+        JSONDict *loc = jd->getItem("warehouse_location", 18)
+                            ->getValue()
+                            ->getDict();
+        sum += loc->getItem("shelf_number", 12)->getValue()->getInt();
+    }
+    return sum;
+}
+
+/**
+** \returns The sum of the shelf numbers of the records, found with the
+**          interned keys of the document (or with Strings that are not
+**          interned if it has no KeyTable)
+*/
+static int_fast64_t sum_by_string(Document *doc, JSONArray *records)
+{
+    KeyTable *keys = doc->getKeys();
+    String own_location("warehouse_location", 18, false);
+    String own_shelf("shelf_number", 12, false);
+    String *location = &own_location;
+    String *shelf = &own_shelf;
+    if (keys != nullptr)
+    {
+        location = keys->find("warehouse_location", 18);
+        shelf = keys->find("shelf_number", 12);
+    }
+
+    int_fast64_t sum = 0;
+    uint_fast64_t size = records->getSize();
+    for (uint_fast64_t i = 0; i < size; ++i)
+    {
+        JSONDict *jd = records->getValueAt(i)->getDict();
+        JSONDict *loc = jd->getItem(location)->getValue()->getDict();
+        sum += loc->getItem(shelf)->getValue()->getInt();
+    }
+    return sum;
+}
+
+static double elapsed(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now()
+                                         - start)
+        .count();
+}
+
+/*******************************************************************************
+**                                    MAIN                                    **
+*******************************************************************************/
+/**
+** \brief Measures the parsing of an array of records in an arena, the memory
+**        it takes, and the lookups of the keys of the records. Built with and
+**        without -DDISABLE_KEY_INTERNING to compare both
+*/
+int main()
+{
+    std::string s = generate();
+    double parse_t = 1e9;
+    double chars_t = 1e9;
+    double string_t = 1e9;
+    uint_fast64_t bytes = 0;
+    uint_fast64_t nb_keys = 0;
+    int_fast64_t sums[2] = { 0, 0 };
+    for (int run = 0; run < NB_RUNS; ++run)
+    {
+        uint_fast64_t before = nb_alloc_bytes;
+        auto start = std::chrono::steady_clock::now();
+        Document *doc = parse_buffer(s.data(), s.size(), true);
+        double t = elapsed(start);
+        parse_t = t < parse_t ? t : parse_t;
+        bytes = nb_alloc_bytes - before;
+        nb_keys = doc->getKeys() == nullptr ? 0 : doc->getKeys()->getSize();
+
+        JSONArray *records = (JSONArray *)doc->getRoot();
+        start = std::chrono::steady_clock::now();
+        sums[0] = sum_by_chars(records);
+        t = elapsed(start);
+        chars_t = t < chars_t ? t : chars_t;
+
+        start = std::chrono::steady_clock::now();
+        sums[1] = sum_by_string(doc, records);
+        t = elapsed(start);
+        string_t = t < string_t ? t : string_t;
+        delete doc;
+    }
+
+#ifdef DISABLE_KEY_INTERNING
+    const char *name = "copied keys";
+#else
+    const char *name = "interned keys";
+#endif
+    printf("%.1f MB, %-13s : parse %.3f ms, %.1f MB allocated, %lu distinct "
+           "keys\n",
+           s.size() / 1e6, name, parse_t * 1e3, bytes / 1e6,
+           (unsigned long)nb_keys);
+    printf("%.1f MB, %-13s : getItem(chars) %.3f ms, getItem(String) %.3f "
+           "ms\n",
+           s.size() / 1e6, name, chars_t * 1e3, string_t * 1e3);
+    return sums[0] != sums[1];
+}
@@ -0,0 +1,115 @@
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+#include "../src/parser.hpp"
+#include "../src/path.hpp"
+
+/*******************************************************************************
+**                              DEFINES / MACROS                              **
+*******************************************************************************/
+// Number of records of the generated document
+#define NB_RECORDS 200000
+
+// Number of times each measure is repeated (the best time is kept)
+#define NB_RUNS 5
+
+/*******************************************************************************
+**                              LOCAL FUNCTIONS                               **
+*******************************************************************************/
+/**
+** \brief Generates a payload with a few metadata fields and a large array of
+**        records, and writes it in a temporary file
+** \returns The size of the file
+*/
+static uint_fast64_t generate(char *path)
+{
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> real(0, 1e4);
+    char buff[256];
+    std::string s = "{\"meta\": {\"id\": \"payload-1\", \"version\": 3}, "
+                    "\"records\": [";
+    for (uint_fast64_t i = 0; i < NB_RECORDS; ++i)
+    {
+        snprintf(buff, sizeof(buff),
+                 "{\"id\": %lu, \"name\": \"record %lu\", \"price\": %.2f, "
+                 "\"tags\": [\"a\", \"b\", \"c\"], \"dims\": {\"w\": %lu, "
+                 "\"h\": %lu}}%s",
+                 (unsigned long)i, (unsigned long)i, real(rng),
+                 (unsigned long)(rng() % 100), (unsigned long)(rng() % 100),
+                 i + 1 < NB_RECORDS ? ", " : "");
+        s += buff;
+    }
+    s += "], \"stats\": {\"count\": 200000}}";
+
+    int fd = mkstemp(path);
+    FILE *f = fdopen(fd, "w");
+    fwrite(s.data(), 1, s.size(), f);
+    fclose(f);
+    return s.size();
+}
+
+/**
+** \brief Parses the file (lazily or not) and reads a few fields of it
+** \returns The best time, in seconds
+*/
+static double time_fields(char *path, bool lazy, int_fast64_t *sum)
+{
+    Path id("/records/123456/id");
+    Path width("/records/654/dims/w");
+    Path count("stats.count");
+
+    double best = 1e9;
+    for (int run = 0; run < NB_RUNS; ++run)
+    {
+        auto start = std::chrono::steady_clock::now();
+        Document *doc = lazy ? parse_lazy(path, true) : parse(path, true);
+        Value v;
+        if (id.resolve(doc->getRoot(), &v))
+        {
+            *sum += v.getInt();
+        }
+        if (width.resolve(doc->getRoot(), &v))
+        {
+            *sum += v.getInt();
+        }
+        if (count.resolve(doc->getRoot(), &v))
+        {
+            *sum += v.getInt();
+        }
+        delete doc;
+        double t = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+        best = t < best ? t : best;
+    }
+    return best;
+}
+
+/*******************************************************************************
+**                                    MAIN                                    **
+*******************************************************************************/
+/**
+** \brief Measures the time needed to read 3 fields of a large document with a
+**        full parse and with a lazy parse
+*/
+int main()
+{
+    char path[] = "/tmp/json-parser-bench-XXXXXX";
+    double mb = generate(path) / 1e6;
+
+    int_fast64_t sum_full = 0;
+    int_fast64_t sum_lazy = 0;
+    double full = time_fields(path, false, &sum_full);
+    double lazy = time_fields(path, true, &sum_lazy);
+    remove(path);
+
+    printf("%.1f MB, 3 fields : full parse %.2f ms, lazy parse %.2f ms\n", mb,
+           full * 1e3, lazy * 1e3);
+    return sum_full != sum_lazy;
+}
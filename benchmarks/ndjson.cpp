@@ -0,0 +1,104 @@
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "../src/ndjson.hpp"
+#include "../src/parser.hpp"
+
+/*******************************************************************************
+**                              DEFINES / MACROS                              **
+*******************************************************************************/
+// Number of records of the generated document
+#define NB_RECORDS 1000000
+
+// Number of times each measure is repeated (the best time is kept)
+#define NB_RUNS 5
+
+/*******************************************************************************
+**                              LOCAL FUNCTIONS                               **
+*******************************************************************************/
+/**
+** \brief Generates a newline-delimited json file of records and writes it in a
+**        temporary file
+** \returns The size of the file
+*/
+static uint_fast64_t generate(char *path)
+{
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> real(0, 1e4);
+    char buff[256];
+    std::string s;
+    for (uint_fast64_t i = 0; i < NB_RECORDS; ++i)
+    {
+        snprintf(buff, sizeof(buff),
+                 "{\"id\": %lu, \"level\": \"info\", \"msg\": \"request %lu\", "
+                 "\"latency\": %.3f, \"tags\": [\"a\", \"b\"]}\n",
+                 (unsigned long)i, (unsigned long)i, real(rng));
+        s += buff;
+    }
+
+    int fd = mkstemp(path);
+    FILE *f = fdopen(fd, "w");
+    fwrite(s.data(), 1, s.size(), f);
+    fclose(f);
+    return s.size();
+}
+
+/**
+** \brief Reads all the records of the file with the given number of workers
+** \returns The best time, in seconds
+*/
+static double time_records(char *path, uint_fast32_t nb_workers,
+                           uint_fast64_t *nb_records)
+{
+    double best = 1e9;
+    for (int run = 0; run < NB_RUNS; ++run)
+    {
+        auto start = std::chrono::steady_clock::now();
+        NDJSONReader reader(path, true, nb_workers);
+        Document *doc = nullptr;
+        *nb_records = 0;
+        while (reader.next(&doc))
+        {
+            *nb_records += doc != nullptr;
+            delete doc;
+        }
+        double t = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+        best = t < best ? t : best;
+    }
+    return best;
+}
+
+/*******************************************************************************
+**                                    MAIN                                    **
+*******************************************************************************/
+/**
+** \brief Measures the throughput of the NDJSON reader with 1 worker and with
+**        one worker per core
+*/
+int main()
+{
+    char path[] = "/tmp/json-parser-bench-XXXXXX";
+    double mb = generate(path) / 1e6;
+
+    uint_fast32_t nb_cores = std::thread::hardware_concurrency();
+    uint_fast64_t nb_single = 0;
+    uint_fast64_t nb_multi = 0;
+    double single = time_records(path, 1, &nb_single);
+    double multi = time_records(path, 0, &nb_multi);
+    remove(path);
+
+    printf("%.1f MB, %lu records : 1 worker %.2f ms (%.0f MB/s), %lu workers "
+           "%.2f ms (%.0f MB/s)\n",
+           mb, (unsigned long)nb_single, single * 1e3, mb / single,
+           (unsigned long)nb_cores, multi * 1e3, mb / multi);
+    return nb_single != NB_RECORDS || nb_multi != NB_RECORDS;
+}
@@ -0,0 +1,151 @@
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+#include "../src/number.hpp"
+#include "../src/parser.hpp"
+
+/*******************************************************************************
+**                              DEFINES / MACROS                              **
+*******************************************************************************/
+// Number of numbers of each generated array
+#define NB_NUMBERS 2000000
+
+// Number of times each measure is repeated (the best time is kept)
+#define NB_RUNS 5
+
+/*******************************************************************************
+**                              LOCAL FUNCTIONS                               **
+*******************************************************************************/
+/**
+** \brief Generates the content of a json array of NB_NUMBERS numbers
+** \param kind 0 for integers, 1 for doubles printed with all their digits, 2
+**             for doubles with 2 decimals, 3 for doubles with an exponent
+*/
+static std::string generate(int kind)
+{
+    std::mt19937_64 rng(kind);
+    std::uniform_real_distribution<double> real(-1e6, 1e6);
+    char buff[64];
+    std::string s = "[";
+    for (uint_fast64_t i = 0; i < NB_NUMBERS; ++i)
+    {
+        switch (kind)
+        {
+        case 0:
+            snprintf(buff, sizeof(buff), "%lld", (long long)rng() >> (i % 48));
+            break;
+        case 1:
+            snprintf(buff, sizeof(buff), "%.17g", real(rng));
+            break;
+        case 2:
+            snprintf(buff, sizeof(buff), "%.2f", real(rng));
+            break;
+        default:
+            snprintf(buff, sizeof(buff), "%.12e",
+                     real(rng) * (rng() % 2 ? 1e-200 : 1e200));
+            break;
+        }
+        s += buff;
+        s += i + 1 < NB_NUMBERS ? "," : "]";
+    }
+    return s;
+}
+
+/**
+** \brief Reads all the numbers of the array with read_number() if 'fast' is
+**        true, with strtod() otherwise
+** \returns The best time, in seconds
+*/
+static double time_numbers(const std::string &s, bool fast, double *sum)
+{
+    double best = 1e9;
+    for (int run = 0; run < NB_RUNS; ++run)
+    {
+        auto start = std::chrono::steady_clock::now();
+        const char *str = s.c_str() + 1;
+        const char *end = s.c_str() + s.size();
+        Number n;
+        while (str < end)
+        {
+            if (fast)
+            {
+                str += read_number(str, end - str, &n);
+                *sum += n.is_float ? n.d : n.i;
+            }
+            else
+            {
+                char *next = nullptr;
+                *sum += strtod(str, &next);
+                str = next;
+            }
+            ++str; // ',' or ']'
+        }
+        double t = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+        best = t < best ? t : best;
+    }
+    return best;
+}
+
+/**
+** \brief Parses the array from a file
+** \returns The best time, in seconds
+*/
+static double time_parse(const std::string &s)
+{
+    char path[] = "/tmp/json-parser-bench-XXXXXX";
+    int fd = mkstemp(path);
+    FILE *f = fdopen(fd, "w");
+    fwrite(s.data(), 1, s.size(), f);
+    fclose(f);
+
+    double best = 1e9;
+    for (int run = 0; run < NB_RUNS; ++run)
+    {
+        auto start = std::chrono::steady_clock::now();
+        Document *doc = parse(path, true);
+        double t = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+        best = t < best ? t : best;
+        delete doc;
+    }
+    remove(path);
+    return best;
+}
+
+/*******************************************************************************
+**                                    MAIN                                    **
+*******************************************************************************/
+/**
+** \brief Measures the throughput of the number parsing on arrays of numbers,
+**        with read_number() alone (compared to strtod()) and with the whole
+**        parser
+*/
+int main()
+{
+    static const char *names[] = { "integers", "doubles %.17g", "doubles %.2f",
+                                   "doubles %.12e" };
+
+    double sum = 0;
+    printf("%-14s %8s %14s %14s %14s\n", "array", "MB", "read_number",
+           "strtod", "parse");
+    for (int kind = 0; kind < 4; ++kind)
+    {
+        std::string s = generate(kind);
+        double mb = s.size() / 1e6;
+        double fast = time_numbers(s, true, &sum);
+        double slow = time_numbers(s, false, &sum);
+        double full = time_parse(s);
+        printf("%-14s %8.1f %9.0f MB/s %9.0f MB/s %9.0f MB/s\n", names[kind],
+               mb, mb / fast, mb / slow, mb / full);
+    }
+    return sum == 0;
+}
@@ -0,0 +1,121 @@
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "../src/parser.hpp"
+
+/*******************************************************************************
+**                              DEFINES / MACROS                              **
+*******************************************************************************/
+// Number of records of the generated document
+#define NB_RECORDS 500000
+
+// Number of times each measure is repeated (the best time is kept)
+#define NB_RUNS 5
+
+/*******************************************************************************
+**                              LOCAL FUNCTIONS                               **
+*******************************************************************************/
+/**
+** \brief Generates an array of records of uneven sizes (some of them have a
+**        long list of tags) and writes it in a temporary file
+** \returns The size of the file
+*/
+static uint_fast64_t generate(char *path)
+{
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> real(0, 1e4);
+    char buff[256];
+    std::string s = "[";
+    for (uint_fast64_t i = 0; i < NB_RECORDS; ++i)
+    {
+        snprintf(buff, sizeof(buff),
+                 "{\"id\": %lu, \"name\": \"record %lu\", \"price\": %.2f, "
+                 "\"tags\": [",
+                 (unsigned long)i, (unsigned long)i, real(rng));
+        s += buff;
+        uint_fast64_t nb_tags = rng() % 100 == 0 ? 200 : 2;
+        for (uint_fast64_t t = 0; t < nb_tags; ++t)
+        {
+            s += t == 0 ? "\"tag\"" : ", \"tag\"";
+        }
+        s += i + 1 < NB_RECORDS ? "]}, " : "]}";
+    }
+    s += "]";
+
+    int fd = mkstemp(path);
+    FILE *f = fdopen(fd, "w");
+    fwrite(s.data(), 1, s.size(), f);
+    fclose(f);
+    return s.size();
+}
+
+/**
+** \brief Parses the file with parse_parallel() and the given number of
+**        workers, or with parse() if it is 0
+** \returns The best time, in seconds
+*/
+static double time_parse(char *path, uint_fast32_t nb_workers,
+                         uint_fast64_t *nb_elements)
+{
+    double best = 1e9;
+    for (int run = 0; run < NB_RUNS; ++run)
+    {
+        auto start = std::chrono::steady_clock::now();
+        Document *doc = nb_workers == 0
+            ? parse(path, true)
+            : parse_parallel(path, true, nb_workers);
+        *nb_elements = ((JSONArray *)doc->getRoot())->getSize();
+        delete doc;
+        double t = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+        best = t < best ? t : best;
+    }
+    return best;
+}
+
+/*******************************************************************************
+**                                    MAIN                                    **
+*******************************************************************************/
+/**
+** \brief Measures the time needed to parse a large array with parse(), and
+**        with parse_parallel() for 1 to N workers (N being the number of
+**        cores, doubling the number of workers each time)
+*/
+int main()
+{
+    char path[] = "/tmp/json-parser-bench-XXXXXX";
+    double mb = generate(path) / 1e6;
+
+    uint_fast64_t nb_seq = 0;
+    double seq = time_parse(path, 0, &nb_seq);
+    printf("%.1f MB, parse() : %.2f ms (%.0f MB/s)\n", mb, seq * 1e3,
+           mb / seq);
+
+    uint_fast32_t nb_cores = std::thread::hardware_concurrency();
+    bool same = true;
+    uint_fast32_t w = 1;
+    while (1)
+    {
+        uint_fast64_t nb = 0;
+        double t = time_parse(path, w, &nb);
+        same = same && nb == nb_seq;
+        printf("parse_parallel(), %2lu worker(s) : %.2f ms (%.0f MB/s, "
+               "x%.2f)\n",
+               (unsigned long)w, t * 1e3, mb / t, seq / t);
+        if (w >= nb_cores)
+        {
+            break;
+        }
+        w = w * 2 < nb_cores ? w * 2 : nb_cores;
+    }
+    remove(path);
+    return !same;
+}
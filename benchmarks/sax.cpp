@@ -0,0 +1,185 @@
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+#include "../src/handler.hpp"
+#include "../src/parser.hpp"
+
+/*******************************************************************************
+**                              DEFINES / MACROS                              **
+*******************************************************************************/
+// Number of records of the generated document
+#define NB_RECORDS 500000
+
+// Number of times each measure is repeated (the best time is kept)
+#define NB_RUNS 5
+
+/*******************************************************************************
+**                                   CLASSES                                  **
+*******************************************************************************/
+/**
+** \class PriceSum Handler that sums the values of the "price" keys
+** \param is_price Whether the last key is "price"
+** \param sum The sum of the prices
+** \param count The number of prices
+*/
+class PriceSum : public Handler
+{
+public:
+    bool is_price = false;
+    double sum = 0;
+    uint_fast64_t count = 0;
+
+    bool onStartArray() override
+    {
+        return true;
+    }
+
+    bool onEndArray() override
+    {
+        return true;
+    }
+
+    bool onStartObject() override
+    {
+        return true;
+    }
+
+    bool onEndObject() override
+    {
+        return true;
+    }
+
+    bool onKey(const char *str, uint_fast64_t len, bool) override
+    {
+        is_price = len == 5 && std::memcmp(str, "price", 5) == 0;
+        return true;
+    }
+
+    bool onString(const char *, uint_fast64_t, bool) override
+    {
+        return true;
+    }
+
+    bool onInt(int_fast64_t i) override
+    {
+        return onDouble(i);
+    }
+
+    bool onDouble(double d) override
+    {
+        if (is_price)
+        {
+            sum += d;
+            ++count;
+        }
+        return true;
+    }
+
+    bool onBool(bool) override
+    {
+        return true;
+    }
+
+    bool onNull() override
+    {
+        return true;
+    }
+};
+
+/*******************************************************************************
+**                              LOCAL FUNCTIONS                               **
+*******************************************************************************/
+/**
+** \brief Generates an array of records and writes it in a temporary file
+** \returns The size of the file
+*/
+static uint_fast64_t generate(char *path)
+{
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> real(0, 1e4);
+    char buff[256];
+    std::string s = "[";
+    for (uint_fast64_t i = 0; i < NB_RECORDS; ++i)
+    {
+        snprintf(buff, sizeof(buff),
+                 "{\"id\": %lu, \"name\": \"record %lu\", \"price\": %.2f, "
+                 "\"tags\": [\"a\", \"b\"], \"ok\": %s}%s",
+                 (unsigned long)i, (unsigned long)i, real(rng),
+                 rng() % 2 ? "true" : "false", i + 1 < NB_RECORDS ? ", " : "");
+        s += buff;
+    }
+    s += "]";
+
+    int fd = mkstemp(path);
+    FILE *f = fdopen(fd, "w");
+    fwrite(s.data(), 1, s.size(), f);
+    fclose(f);
+    return s.size();
+}
+
+/**
+** \brief Sums the prices of the records, from the events of the parser if
+**        'sax' is true, from the parsed json object otherwise
+** \returns The best time, in seconds
+*/
+static double time_sum(char *path, bool sax, double *sum)
+{
+    double best = 1e9;
+    for (int run = 0; run < NB_RUNS; ++run)
+    {
+        auto start = std::chrono::steady_clock::now();
+        *sum = 0;
+        if (sax)
+        {
+            PriceSum handler;
+            parse(path, &handler);
+            *sum = handler.sum;
+        }
+        else
+        {
+            Document *doc = parse(path, true);
+            JSONArray *ja = (JSONArray *)doc->getRoot();
+            for (uint_fast64_t i = 0; i < ja->getSize(); ++i)
+            {
+                Item *it = ja->getValueAt(i)->getDict()->getItem("price", 5);
+                *sum += it->getValue()->getDouble();
+            }
+            delete doc;
+        }
+        double t = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+        best = t < best ? t : best;
+    }
+    return best;
+}
+
+/*******************************************************************************
+**                                    MAIN                                    **
+*******************************************************************************/
+/**
+** \brief Measures the time needed to sum a field of all the records of a large
+**        array, with the events of the parser and with the json object
+*/
+int main()
+{
+    char path[] = "/tmp/json-parser-bench-XXXXXX";
+    double mb = generate(path) / 1e6;
+
+    double sum_sax = 0;
+    double sum_dom = 0;
+    double sax = time_sum(path, true, &sum_sax);
+    double dom = time_sum(path, false, &sum_dom);
+    remove(path);
+
+    printf("%.1f MB, sum of the prices : handler %.2f ms, json object %.2f ms\n",
+           mb, sax * 1e3, dom * 1e3);
+    return sum_sax != sum_dom;
+}
@@ -0,0 +1,147 @@
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/parser.hpp"
+#include "alloc_count.hpp"
+
+/*******************************************************************************
+**                              DEFINES / MACROS                              **
+*******************************************************************************/
+// Number of generated documents
+#define NB_DOCS 100000
+
+// Number of times each measure is repeated (the best time is kept)
+#define NB_RUNS 5
+
+/*******************************************************************************
+**                              LOCAL FUNCTIONS                               **
+*******************************************************************************/
+/**
+** \brief Generates NB_DOCS small documents, like the requests of a service
+**        (between a few hundred bytes and about 1 KB)
+** \returns The total size of the documents
+*/
+static uint_fast64_t generate(std::vector<std::string> *docs)
+{
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> real(0, 1e4);
+    char buff[512];
+    uint_fast64_t total = 0;
+    for (uint_fast64_t i = 0; i < NB_DOCS; ++i)
+    {
+        snprintf(buff, sizeof(buff),
+                 "{\"id\": %lu, \"user\": \"user-%lu\", \"amount\": %.2f, "
+                 "\"currency\": \"EUR\", \"note\": \"line\\nbreak\", "
+                 "\"items\": [",
+                 (unsigned long)i, (unsigned long)(rng() % 100000),
+                 real(rng));
+        std::string s = buff;
+        uint_fast64_t nb_items = 1 + rng() % 8;
+        for (uint_fast64_t k = 0; k < nb_items; ++k)
+        {
+            snprintf(buff, sizeof(buff),
+                     "%s{\"sku\": \"SKU-%lu\", \"qty\": %lu, \"gift\": %s}",
+                     k == 0 ? "" : ", ", (unsigned long)(rng() % 1000000),
+                     (unsigned long)(1 + rng() % 5),
+                     rng() % 2 ? "true" : "false");
+            s += buff;
+        }
+        s += "], \"meta\": null}";
+        total += s.size();
+        docs->push_back(s);
+    }
+    return total;
+}
+
+/**
+** \brief Parses all the documents, with parse_buffer(chars, len) if 'mode' is
+**        0, with parse_buffer(chars, len, true) if it is 1, and with a single
+**        Parser if it is 2
+** \param allocs Set to the number of allocations of the last run
+** \param nb_values Set to the number of values of the roots of the documents
+** \returns The best time, in seconds
+*/
+static double time_parse(std::vector<std::string> *docs, int mode,
+                         uint_fast64_t *allocs, uint_fast64_t *nb_values)
+{
+    double best = 1e9;
+    Parser parser;
+    for (int run = 0; run < NB_RUNS; ++run)
+    {
+        *nb_values = 0;
+        uint_fast64_t start_allocs = nb_allocs;
+        auto start = std::chrono::steady_clock::now();
+        for (std::string &s : *docs)
+        {
+            JSON *j = nullptr;
+            Document *doc = nullptr;
+            if (mode == 0)
+            {
+                j = parse_buffer(s.data(), s.size());
+            }
+            else if (mode == 1)
+            {
+                doc = parse_buffer(s.data(), s.size(), true);
+                j = doc == nullptr ? nullptr : doc->getRoot();
+            }
+            else
+            {
+                j = parser.parse(s.data(), s.size());
+            }
+
+            *nb_values += j == nullptr ? 0 : ((JSONDict *)j)->getSize();
+            if (mode == 0)
+            {
+                delete j;
+            }
+            delete doc;
+        }
+        double t = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+        best = t < best ? t : best;
+        *allocs = nb_allocs - start_allocs;
+    }
+    return best;
+}
+
+/*******************************************************************************
+**                                    MAIN                                    **
+*******************************************************************************/
+/**
+** \brief Measures the time and the number of allocations needed to parse many
+**        small documents with parse_buffer() (with and without arena) and
+**        with a Parser that is reused for all of them
+*/
+int main()
+{
+    std::vector<std::string> docs;
+    double mb = generate(&docs) / 1e6;
+
+    static const char *const names[] = {
+        "parse_buffer(chars, len)",
+        "parse_buffer(chars, len, true)",
+        "Parser::parse(chars, len)",
+    };
+    uint_fast64_t expected = 0;
+    bool same = true;
+    for (int mode = 0; mode < 3; ++mode)
+    {
+        uint_fast64_t allocs = 0;
+        uint_fast64_t nb_values = 0;
+        double t = time_parse(&docs, mode, &allocs, &nb_values);
+        expected = mode == 0 ? nb_values : expected;
+        same = same && nb_values == expected;
+        printf("%d docs (%.1f MB), %-26s : %.2f ms (%.0f ns/doc, %.0f MB/s), "
+               "%.2f allocations/doc\n",
+               NB_DOCS, mb, names[mode], t * 1e3, t * 1e9 / NB_DOCS, mb / t,
+               (double)allocs / NB_DOCS);
+    }
+    return !same;
+}
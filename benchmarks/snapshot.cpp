@@ -0,0 +1,156 @@
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+#include "../src/parser.hpp"
+#include "../src/snapshot.hpp"
+
+/*******************************************************************************
+**                              DEFINES / MACROS                              **
+*******************************************************************************/
+// Number of records of the generated document
+#define NB_RECORDS 200000
+
+// Number of times each measure is repeated (the best time is kept)
+#define NB_RUNS 5
+
+/*******************************************************************************
+**                              LOCAL FUNCTIONS                               **
+*******************************************************************************/
+/**
+** \brief Generates a configuration-like dict with a large array of records,
+**        and writes it in a temporary file
+** \returns The size of the file
+*/
+static uint_fast64_t generate(char *path)
+{
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> real(0, 1e4);
+    char buff[256];
+    std::string s = "{\"version\": 3, \"records\": [";
+    for (uint_fast64_t i = 0; i < NB_RECORDS; ++i)
+    {
+        snprintf(buff, sizeof(buff),
+                 "{\"id\": %lu, \"name\": \"record %lu\", \"price\": %.2f, "
+                 "\"tags\": [\"a\", \"b\", \"c\"], \"dims\": {\"w\": %lu, "
+                 "\"h\": %lu}}%s",
+                 (unsigned long)i, (unsigned long)i, real(rng),
+                 (unsigned long)(rng() % 100), (unsigned long)(rng() % 100),
+                 i + 1 < NB_RECORDS ? ", " : "");
+        s += buff;
+    }
+    s += "]}";
+
+    int fd = mkstemp(path);
+    FILE *f = fdopen(fd, "w");
+    fwrite(s.data(), 1, s.size(), f);
+    fclose(f);
+    return s.size();
+}
+
+/**
+** \returns The sum of the ids of the records of the tape, -1 if the tape is
+**          nullptr
+*/
+static int_fast64_t sum_ids(Tape *t)
+{
+    if (t == nullptr)
+    {
+        return -1;
+    }
+
+    int_fast64_t sum = 0;
+    TapeArray records = t->getDict().getItem("records", 7).getValue().getArray();
+    TapeValue v = records.getFirst();
+    for (uint_fast64_t i = 0; i < records.getSize(); ++i, v = v.getNext())
+    {
+        sum += v.getDict().getItem("id", 2).getValue().getInt();
+    }
+    return sum;
+}
+
+/**
+** \brief Loads the file with parse_tape() ('mode' 0), with parse_cached()
+**        without snapshot ('mode' 1), with parse_cached() with an up to date
+**        snapshot ('mode' 2), or after the time of modification of the file
+**        changed ('mode' 3, the file is then hashed)
+** \param sum Set to the sum of the ids of the records
+** \returns The best time of the loading, in seconds
+*/
+static double time_load(char *path, char *snapshot, int mode,
+                        int_fast64_t *sum)
+{
+    double best = 1e9;
+    for (int run = 0; run < NB_RUNS; ++run)
+    {
+        if (mode == 1)
+        {
+            unlink(snapshot);
+        }
+        else if (mode == 3)
+        {
+            // Sets the time of modification to the current time
+            utime(path, nullptr);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        Tape *t = mode == 0 ? parse_tape(path) : parse_cached(path, snapshot);
+        double time = std::chrono::duration<double>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+        best = time < best ? time : best;
+
+        *sum = sum_ids(t);
+        delete t;
+    }
+    return best;
+}
+
+/*******************************************************************************
+**                                    MAIN                                    **
+*******************************************************************************/
+/**
+** \brief Measures the time needed to get a tape of a large file by parsing it,
+**        and by loading its snapshot
+*/
+int main()
+{
+    char path[] = "/tmp/bench-snapshot-XXXXXX";
+    double mb = generate(path) / 1e6;
+    std::string snapshot = std::string(path) + ".snapshot";
+    char *snap = (char *)snapshot.c_str();
+
+    static const char *const names[] = {
+        "parse_tape()",
+        "parse_cached(), no snapshot",
+        "parse_cached(), up to date",
+        "parse_cached(), touched",
+    };
+    int_fast64_t expected = 0;
+    bool same = true;
+    for (int mode = 0; mode < 4; ++mode)
+    {
+        int_fast64_t sum = 0;
+        double t = time_load(path, snap, mode, &sum);
+        expected = mode == 0 ? sum : expected;
+        same = same && sum == expected;
+        printf("%.1f MB, %-28s : %.3f ms\n", mb, names[mode], t * 1e3);
+    }
+
+    struct stat st;
+    if (stat(snap, &st) == 0)
+    {
+        printf("snapshot : %.1f MB\n", st.st_size / 1e6);
+    }
+    unlink(snap);
+    unlink(path);
+    return !same;
+}
@@ -0,0 +1,455 @@
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../src/parser.hpp"
+#include "../src/serializer.hpp"
+#include "alloc_count.hpp"
+
+/*******************************************************************************
+**                              DEFINES / MACROS                              **
+*******************************************************************************/
+// Approximate size of each generated document (multiplied by --scale)
+#define CORPUS_SIZE (8 << 20) // 8 MiB
+
+// Number of times each measure is repeated (the best time is kept)
+#define NB_RUNS 5
+
+// Depth of the nested containers of the "nested" corpus
+#define NESTED_DEPTH 64
+
+// Number of keys of each dict of the "wide" corpus
+#define WIDE_NB_KEYS 10000
+
+/*******************************************************************************
+**                                   CLASSES                                  **
+*******************************************************************************/
+/**
+** \class Corpus Kind of generated document
+** \param name The name of the corpus in the results
+** \param generate Appends the document to 's', whose size must reach about
+**                 'size' characters, and returns its number of values (the
+**                 containers included)
+*/
+class Corpus
+{
+public:
+    const char *name;
+    uint_fast64_t (*generate)(std::mt19937_64 *rng, uint_fast64_t size,
+                              std::string *s);
+};
+
+/**
+** \class Result Measures of a corpus
+** \param parse The best time of parse(), in seconds
+** \param print The best time of the compact serialization, in seconds
+** \param teardown The best time of the deletion of the document, in seconds
+** \param out_size The number of characters of the serialization
+** \param allocs The number of calls to operator new during parse()
+** \param peak_rss The peak resident set size of the process, in KiB
+*/
+class Result
+{
+public:
+    double parse = 1e9;
+    double print = 1e9;
+    double teardown = 1e9;
+    uint_fast64_t out_size = 0;
+    uint_fast64_t allocs = 0;
+    long peak_rss = 0;
+};
+
+/*******************************************************************************
+**                                 GENERATORS                                 **
+*******************************************************************************/
+/**
+** \brief Array of rows of 8 numbers : integers of all sizes, doubles with all
+**        their digits, with 2 decimals and with an exponent
+*/
+static uint_fast64_t gen_numbers(std::mt19937_64 *rng, uint_fast64_t size,
+                                 std::string *s)
+{
+    std::uniform_real_distribution<double> real(-1e6, 1e6);
+    char buff[256];
+    uint_fast64_t nb_values = 1;
+    *s += "[";
+    while (s->size() < size)
+    {
+        snprintf(buff, sizeof(buff),
+                 "[%lld, %lld, %d, %.17g, %.2f, %.12e, %.3f, %d],",
+                 (long long)(*rng)() >> 1, (long long)(*rng)() >> 40,
+                 (int)((*rng)() % 100), real(*rng), real(*rng),
+                 real(*rng) * 1e-100, real(*rng) / 1e3, -(int)((*rng)() % 10));
+        *s += buff;
+        nb_values += 9;
+    }
+    s->back() = ']';
+    return nb_values;
+}
+
+/**
+** \brief Array of records whose values are mostly long ascii strings
+*/
+static uint_fast64_t gen_strings(std::mt19937_64 *rng, uint_fast64_t size,
+                                 std::string *s)
+{
+    uint_fast64_t nb_values = 1;
+    *s += "[";
+    while (s->size() < size)
+    {
+        *s += "{\"title\": \"";
+        uint_fast64_t len = 16 + (*rng)() % 200;
+        for (uint_fast64_t i = 0; i < len; ++i)
+        {
+            uint_fast64_t r = (*rng)() % 32;
+            *s += r < 26 ? (char)('a' + r) : ' ';
+        }
+        *s += "\", \"author\": \"someone\", \"lang\": \"en\"},";
+        nb_values += 4;
+    }
+    s->back() = ']';
+    return nb_values;
+}
+
+/**
+** \brief Array of chains of NESTED_DEPTH containers, alternating dicts and
+**        arrays, with a single number at their bottom
+*/
+static uint_fast64_t gen_nested(std::mt19937_64 *rng, uint_fast64_t size,
+                                std::string *s)
+{
+    uint_fast64_t nb_values = 1;
+    *s += "[";
+    while (s->size() < size)
+    {
+        for (uint_fast64_t d = 0; d < NESTED_DEPTH; ++d)
+        {
+            *s += d % 2 == 0 ? "{\"k\": " : "[";
+        }
+        *s += std::to_string((*rng)() % 1000);
+        for (uint_fast64_t d = NESTED_DEPTH; d > 0; --d)
+        {
+            *s += (d - 1) % 2 == 0 ? "}" : "]";
+        }
+        *s += ",";
+        nb_values += NESTED_DEPTH + 1;
+    }
+    s->back() = ']';
+    return nb_values;
+}
+
+/**
+** \brief Array of dicts of WIDE_NB_KEYS keys each
+*/
+static uint_fast64_t gen_wide(std::mt19937_64 *rng, uint_fast64_t size,
+                              std::string *s)
+{
+    char buff[64];
+    uint_fast64_t nb_values = 1;
+    *s += "[";
+    while (s->size() < size)
+    {
+        *s += "{";
+        for (uint_fast64_t k = 0; k < WIDE_NB_KEYS; ++k)
+        {
+            snprintf(buff, sizeof(buff), "\"field_%lu\": %lu%s",
+                     (unsigned long)k, (unsigned long)((*rng)() % 100000),
+                     k + 1 < WIDE_NB_KEYS ? ", " : "");
+            *s += buff;
+        }
+        *s += "},";
+        nb_values += WIDE_NB_KEYS + 1;
+    }
+    s->back() = ']';
+    return nb_values;
+}
+
+/**
+** \brief Flat array of small scalars : integers, booleans, nulls and short
+**        strings
+*/
+static uint_fast64_t gen_huge_array(std::mt19937_64 *rng, uint_fast64_t size,
+                                    std::string *s)
+{
+    static const char *const scalars[] = { "true", "false", "null", "\"ab\"" };
+    uint_fast64_t nb_values = 1;
+    *s += "[";
+    while (s->size() < size)
+    {
+        uint_fast64_t r = (*rng)() % 8;
+        if (r < 4)
+        {
+            *s += scalars[r];
+        }
+        else
+        {
+            *s += std::to_string((*rng)() % 10000);
+        }
+        *s += ",";
+        ++nb_values;
+    }
+    s->back() = ']';
+    return nb_values;
+}
+
+/**
+** \brief Array of strings full of escape sequences : quotes, backslashes,
+**        control characters, and \u escapes (surrogate pairs included)
+*/
+static uint_fast64_t gen_escapes(std::mt19937_64 *rng, uint_fast64_t size,
+                                 std::string *s)
+{
+    static const char *const escapes[] = {
+        "\\\"", "\\\\", "\\n", "\\t", "\\/", "\\u00e9", "\\u20ac",
+        "\\ud83d\\ude00", "abc", "xyz",
+    };
+    uint_fast64_t nb_values = 1;
+    *s += "[";
+    while (s->size() < size)
+    {
+        *s += "\"";
+        uint_fast64_t len = 4 + (*rng)() % 40;
+        for (uint_fast64_t i = 0; i < len; ++i)
+        {
+            *s += escapes[(*rng)() % 10];
+        }
+        *s += "\",";
+        ++nb_values;
+    }
+    s->back() = ']';
+    return nb_values;
+}
+
+static const Corpus corpora[] = {
+    { "numbers", gen_numbers },       { "strings", gen_strings },
+    { "nested", gen_nested },         { "wide", gen_wide },
+    { "huge_array", gen_huge_array }, { "escapes", gen_escapes },
+};
+
+/*******************************************************************************
+**                              LOCAL FUNCTIONS                               **
+*******************************************************************************/
+/**
+** \brief Writes the given document in a temporary file
+*/
+static void write_file(char *path, const std::string &s)
+{
+    int fd = mkstemp(path);
+    FILE *f = fdopen(fd, "w");
+    fwrite(s.data(), 1, s.size(), f);
+    fclose(f);
+}
+
+static double elapsed(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now()
+                                         - start)
+        .count();
+}
+
+/**
+** \brief Parses, prints and deletes the document of the given file NB_RUNS
+**        times
+** \returns false if the file could not be parsed
+*/
+static bool measure(char *path, bool use_arena, Result *res)
+{
+    for (int run = 0; run < NB_RUNS; ++run)
+    {
+        uint_fast64_t allocs = nb_allocs;
+        auto start = std::chrono::steady_clock::now();
+        Document *doc = parse(path, use_arena);
+        double t = elapsed(start);
+        res->parse = t < res->parse ? t : res->parse;
+        res->allocs = nb_allocs - allocs;
+        if (doc == nullptr || doc->getRoot() == nullptr)
+        {
+            delete doc;
+            return false;
+        }
+
+        start = std::chrono::steady_clock::now();
+        {
+            Serializer s(false);
+            s.writeJSON(doc->getRoot());
+            res->out_size = s.getSize();
+        }
+        t = elapsed(start);
+        res->print = t < res->print ? t : res->print;
+
+        start = std::chrono::steady_clock::now();
+        delete doc;
+        t = elapsed(start);
+        res->teardown = t < res->teardown ? t : res->teardown;
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    res->peak_rss = usage.ru_maxrss;
+    return true;
+}
+
+/**
+** \brief Measures the given file in a child process, so that the peak resident
+**        set size is the one of this corpus only
+** \returns false if the measure failed
+*/
+static bool measure_in_child(char *path, bool use_arena, Result *res)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        return false;
+    }
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        close(fds[0]);
+        bool ok = measure(path, use_arena, res);
+        ok = ok && write(fds[1], res, sizeof(Result)) == sizeof(Result);
+        _exit(ok ? 0 : 1);
+    }
+
+    close(fds[1]);
+    bool ok = pid > 0 && read(fds[0], res, sizeof(Result)) == sizeof(Result);
+    close(fds[0]);
+    int status = 0;
+    if (pid > 0)
+    {
+        waitpid(pid, &status, 0);
+    }
+    return ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+/**
+** \brief Prints the measures of a corpus, as a line of a table or as a json
+**        object
+*/
+static void print_result(const char *name, bool use_arena, uint_fast64_t size,
+                         uint_fast64_t nb_values, Result *res, bool json,
+                         bool first)
+{
+    double mb = size / 1e6;
+    double ns_parse = res->parse * 1e9 / nb_values;
+    double ns_print = res->print * 1e9 / nb_values;
+    double ns_teardown = res->teardown * 1e9 / nb_values;
+    if (json)
+    {
+        printf("%s\n    {\"corpus\": \"%s\", \"arena\": %s, \"size\": %lu, "
+               "\"values\": %lu,\n"
+               "     \"parse_ms\": %.3f, \"parse_mb_s\": %.1f, "
+               "\"parse_ns_per_value\": %.2f,\n"
+               "     \"print_ms\": %.3f, \"print_mb_s\": %.1f, "
+               "\"print_ns_per_value\": %.2f,\n"
+               "     \"teardown_ms\": %.3f, \"teardown_ns_per_value\": %.2f,\n"
+               "     \"allocs_per_doc\": %lu, \"peak_rss_kb\": %ld}",
+               first ? "" : ",", name, use_arena ? "true" : "false",
+               (unsigned long)size, (unsigned long)nb_values,
+               res->parse * 1e3, mb / res->parse, ns_parse, res->print * 1e3,
+               res->out_size / 1e6 / res->print, ns_print,
+               res->teardown * 1e3, ns_teardown, (unsigned long)res->allocs,
+               res->peak_rss);
+        return;
+    }
+    printf("%-10s %-5s %7.1f %9lu | %7.1f %6.1f | %7.1f %6.1f | %6.2f %9lu "
+           "%8ld\n",
+           name, use_arena ? "yes" : "no", mb, (unsigned long)nb_values,
+           mb / res->parse, ns_parse, res->out_size / 1e6 / res->print,
+           ns_print, ns_teardown, (unsigned long)res->allocs,
+           res->peak_rss / 1024);
+}
+
+/*******************************************************************************
+**                                    MAIN                                    **
+*******************************************************************************/
+/**
+** \brief Generates a reproducible corpus of documents of several kinds, and
+**        measures for each of them (with and without arena) the throughput of
+**        parse() and of the compact serialization, the time per value of the
+**        parsing, printing and teardown, the number of allocations of the
+**        parsing and the peak resident set size.
+**        With the '--json' option, the results are printed as json, to be
+**        compared between two versions of the parser. '--scale <n>' multiplies
+**        the size of the documents
+**        Usage : bench-suite [--json] [--scale <n>]
+*/
+int main(int argc, char *argv[])
+{
+    bool json = false;
+    uint_fast64_t scale = 1;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--json") == 0)
+        {
+            json = true;
+        }
+        else if (strcmp(argv[i], "--scale") == 0 && i + 1 < argc)
+        {
+            scale = strtoul(argv[++i], nullptr, 10);
+        }
+    }
+    scale = scale == 0 ? 1 : scale;
+
+    if (json)
+    {
+        printf("{\"runs\": %d, \"results\": [", NB_RUNS);
+    }
+    else
+    {
+        printf("%-10s %-5s %7s %9s | %7s %6s | %7s %6s | %6s %9s %8s\n",
+               "corpus", "arena", "MB", "values", "parse", "ns/val", "print",
+               "ns/val", "del ns", "allocs", "peak MB");
+        printf("%-10s %-5s %7s %9s | %7s %6s | %7s %6s | %6s %9s %8s\n", "",
+               "", "", "", "MB/s", "", "MB/s", "", "/val", "/doc", "RSS");
+    }
+
+    bool ok = true;
+    bool first = true;
+    for (uint_fast64_t c = 0; c < sizeof(corpora) / sizeof(Corpus); ++c)
+    {
+        // Each corpus has its own seed, so it does not depend on the others
+        const Corpus &corpus = corpora[c];
+        std::mt19937_64 rng(c + 1);
+        std::string s;
+        uint_fast64_t nb_values = corpus.generate(&rng, CORPUS_SIZE * scale,
+                                                  &s);
+        char path[] = "/tmp/json-parser-bench-XXXXXX";
+        write_file(path, s);
+        uint_fast64_t size = s.size();
+        std::string().swap(s);
+
+        for (int use_arena = 1; use_arena >= 0; --use_arena)
+        {
+            // Flushed so that the child does not print it again
+            fflush(stdout);
+            Result res;
+            if (!measure_in_child(path, use_arena, &res))
+            {
+                fprintf(stderr, "%s : the document could not be parsed\n",
+                        corpus.name);
+                ok = false;
+                continue;
+            }
+            print_result(corpus.name, use_arena, size, nb_values, &res, json,
+                         first);
+            first = false;
+        }
+        remove(path);
+    }
+
+    if (json)
+    {
+        printf("\n]}\n");
+    }
+    return !ok;
+}
@@ -0,0 +1,245 @@
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+
+#include "../src/parser.hpp"
+#include "alloc_count.hpp"
+
+/*******************************************************************************
+**                              DEFINES / MACROS                              **
+*******************************************************************************/
+// Number of records of the generated document
+#define NB_RECORDS 200000
+
+// Number of times each measure is repeated (the best time is kept)
+#define NB_RUNS 5
+
+/*******************************************************************************
+**                              LOCAL FUNCTIONS                               **
+*******************************************************************************/
+/**
+** \brief Generates an array of records with nested containers
+*/
+static std::string generate()
+{
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> real(0, 1e4);
+    char buff[256];
+    std::string s = "[";
+    for (uint_fast64_t i = 0; i < NB_RECORDS; ++i)
+    {
+        snprintf(buff, sizeof(buff),
+                 "{\"id\": %lu, \"name\": \"record %lu\", \"price\": %.2f, "
+                 "\"tags\": [\"a\", \"b\", \"c\"], \"dims\": {\"w\": %lu, "
+                 "\"h\": %lu}, \"active\": %s}%s",
+                 (unsigned long)i, (unsigned long)i, real(rng),
+                 (unsigned long)(rng() % 100), (unsigned long)(rng() % 100),
+                 rng() % 2 ? "true" : "false", i + 1 < NB_RECORDS ? ", " : "");
+        s += buff;
+    }
+    s += "]";
+    return s;
+}
+
+/**
+** \returns The sum of the numbers and of the lengths of the strings and keys
+**          of the given value of a tree
+*/
+static double walk(Value *v);
+
+static double walk(JSONArray *ja)
+{
+    double sum = 0;
+    Value *values = ja->getValues();
+    for (uint_fast64_t i = 0; i < ja->getSize(); ++i)
+    {
+        sum += walk(values + i);
+    }
+    return sum;
+}
+
+static double walk(JSONDict *jd)
+{
+    double sum = 0;
+    Item *items = jd->getItems();
+    for (uint_fast64_t i = 0; i < jd->getSize(); ++i)
+    {
+        sum += items[i].getKey()->len() + walk(items[i].getValue());
+    }
+    return sum;
+}
+
+static double walk(Value *v)
+{
+    switch (v->getType())
+    {
+    case T_STR:
+        return v->getString()->len();
+    case T_INT:
+        return v->getInt();
+    case T_DOUBLE:
+        return v->getDouble();
+    case T_BOOL:
+        return v->getBool();
+    case T_ARR:
+        return walk(v->getArray());
+    case T_DICT:
+        return walk(v->getDict());
+    }
+    return 0;
+}
+
+/**
+** \returns The same sum as walk(Value *), for a value of a tape
+*/
+static double walk(TapeValue v);
+
+static double walk(TapeArray ta)
+{
+    double sum = 0;
+    TapeValue v = ta.getFirst();
+    for (uint_fast64_t i = 0; i < ta.getSize(); ++i, v = v.getNext())
+    {
+        sum += walk(v);
+    }
+    return sum;
+}
+
+static double walk(TapeDict td)
+{
+    double sum = 0;
+    TapeItem item = td.getFirst();
+    for (uint_fast64_t i = 0; i < td.getSize(); ++i, item = item.getNext())
+    {
+        sum += item.getKey().len() + walk(item.getValue());
+    }
+    return sum;
+}
+
+static double walk(TapeValue v)
+{
+    switch (v.getType())
+    {
+    case T_STR:
+        return v.getString().len();
+    case T_INT:
+        return v.getInt();
+    case T_DOUBLE:
+        return v.getDouble();
+    case T_BOOL:
+        return v.getBool();
+    case T_ARR:
+        return walk(v.getArray());
+    case T_DICT:
+        return walk(v.getDict());
+    }
+    return 0;
+}
+
+/**
+** \brief Best times of the parsing, of a walk over all the values and of the
+**        destruction, and number of allocations of the parsing
+*/
+class Result
+{
+public:
+    double parse = 1e9;
+    double walk = 1e9;
+    double free = 1e9;
+    uint_fast64_t allocs = 0;
+    double sum = 0;
+};
+
+static double since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now()
+                                         - start)
+        .count();
+}
+
+/**
+** \brief Measures the tree, on the heap ('mode' 0) or in an arena ('mode' 1),
+**        or the tape ('mode' 2)
+*/
+static Result measure(std::string *s, int mode)
+{
+    Result res;
+    for (int run = 0; run < NB_RUNS; ++run)
+    {
+        uint_fast64_t start_allocs = nb_allocs;
+        auto start = std::chrono::steady_clock::now();
+        Document *doc = nullptr;
+        JSON *j = nullptr;
+        Tape *t = nullptr;
+        if (mode == 0)
+        {
+            j = parse_buffer(s->data(), s->size());
+        }
+        else if (mode == 1)
+        {
+            doc = parse_buffer(s->data(), s->size(), true);
+            j = doc->getRoot();
+        }
+        else
+        {
+            t = parse_tape(s->data(), s->size());
+        }
+        double p = since(start);
+        res.allocs = nb_allocs - start_allocs;
+
+        start = std::chrono::steady_clock::now();
+        res.sum = t == nullptr ? walk((JSONArray *)j) : walk(t->getArray());
+        double w = since(start);
+
+        start = std::chrono::steady_clock::now();
+        if (mode == 0)
+        {
+            delete j;
+        }
+        delete doc;
+        delete t;
+        double f = since(start);
+
+        res.parse = p < res.parse ? p : res.parse;
+        res.walk = w < res.walk ? w : res.walk;
+        res.free = f < res.free ? f : res.free;
+    }
+    return res;
+}
+
+/*******************************************************************************
+**                                    MAIN                                    **
+*******************************************************************************/
+/**
+** \brief Measures the parsing, a walk over all the values and the destruction
+**        of a large array of records, as a tree of JSONArray and JSONDict (on
+**        the heap and in an arena) and as a tape
+*/
+int main()
+{
+    std::string s = generate();
+    double mb = s.size() / 1e6;
+
+    static const char *const names[] = {
+        "tree",
+        "tree (arena)",
+        "tape",
+    };
+    double expected = 0;
+    bool same = true;
+    for (int mode = 0; mode < 3; ++mode)
+    {
+        Result res = measure(&s, mode);
+        expected = mode == 0 ? res.sum : expected;
+        same = same && res.sum == expected;
+        printf("%.1f MB, %-12s : parse %.2f ms (%.0f MB/s), walk %.2f ms, "
+               "free %.2f ms, %lu allocations\n",
+               mb, names[mode], res.parse * 1e3, mb / res.parse,
+               res.walk * 1e3, res.free * 1e3, (unsigned long)res.allocs);
+    }
+    return !same;
+}
@@ -0,0 +1,126 @@
+#include "arena.hpp"
+
+/*******************************************************************************
+**                                   ARENA                                    **
+*******************************************************************************/
+Arena::Arena(uint_fast64_t block_size)
+    : head(nullptr)
+    , used(0)
+    , block_size(block_size)
+    , spare(nullptr)
+{}
+
+Arena::~Arena()
+{
+    reset();
+    while (spare != nullptr)
+    {
+        Block *next = spare->next;
+        delete[] (char *)spare;
+        spare = next;
+    }
+}
+
+/**
+** \brief Removes from the spare blocks the first one that has at least 'size'
+**        bytes
+** \returns The block, or nullptr if there is none
+*/
+Arena::Block *Arena::takeSpare(uint_fast64_t size)
+{
+    Block **prev = &spare;
+    for (Block *b = spare; b != nullptr; prev = &b->next, b = b->next)
+    {
+        if (b->size >= size)
+        {
+            *prev = b->next;
+            return b;
+        }
+    }
+    return nullptr;
+}
+
+/**
+** \brief Takes a new block (a spare one if possible) and takes the requested
+**        memory from it. The allocations larger than the block size get a
+**        block of their own
+*/
+void *Arena::allocBlock(uint_fast64_t size, uint_fast64_t align)
+{
+    // The header of the block is followed by the space needed to align the
+    // first allocation
+    uint_fast64_t header = (sizeof(Block) + align - 1) & ~(align - 1);
+    bool oversized = header + size > block_size;
+    uint_fast64_t total = oversized ? header + size : block_size;
+
+    Block *b = takeSpare(total);
+    if (b == nullptr)
+    {
+        STATS_ALLOC(total);
+        b = (Block *)new char[total];
+        b->size = total;
+    }
+    if (head != nullptr && oversized)
+    {
+        // The current block can still be used for the next allocations
+        b->next = head->next;
+        head->next = b;
+        return (char *)b + header;
+    }
+
+    b->next = head;
+    head = b;
+    used = header + size;
+    return (char *)b + header;
+}
+
+/**
+** \brief Takes the blocks of the given arena, which is left empty, so that
+**        what was allocated in it is freed with this arena. Used to gather in
+**        a single arena the objects that were allocated in parallel, in one
+**        arena per thread
+*/
+void Arena::adopt(Arena *other)
+{
+    if (other == nullptr || other == this || other->head == nullptr)
+    {
+        return;
+    }
+
+    Block *last = other->head;
+    while (last->next != nullptr)
+    {
+        last = last->next;
+    }
+
+    // The current block stays the one in which the allocations are done
+    if (head == nullptr)
+    {
+        head = other->head;
+        used = other->used;
+    }
+    else
+    {
+        last->next = head->next;
+        head->next = other->head;
+    }
+    other->head = nullptr;
+    other->used = 0;
+}
+
+/**
+** \brief Frees everything that was allocated in the arena at once, but keeps
+**        its blocks for the next allocations, so that filling the arena again
+**        with about as much memory does not allocate anything
+*/
+void Arena::reset()
+{
+    while (head != nullptr)
+    {
+        Block *next = head->next;
+        head->next = spare;
+        spare = head;
+        head = next;
+    }
+    used = 0;
+}
@@ -0,0 +1,96 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <new>
+#include <stdint.h>
+
+#include "stats.hpp"
+
+/*******************************************************************************
+**                              DEFINES / MACROS                              **
+*******************************************************************************/
+#ifndef ARENA_BLOCK_SIZE
+#    define ARENA_BLOCK_SIZE (1 << 20) // 1 MiB
+#endif
+
+/*******************************************************************************
+**                                   CLASSES                                  **
+*******************************************************************************/
+/**
+** \class Arena Bump allocator used to allocate all the nodes and strings of a
+**              document
+** \brief The memory is taken from large blocks, one after the other, and is
+**        never freed individually : all the blocks are freed at once when the
+**        arena is destroyed. The objects allocated in an arena must therefore
+**        never be deleted, and their destructors are never called
+** \param head The block in which the allocations are currently done
+** \param used The number of bytes used in the current block
+** \param block_size The size of the blocks
+** \param spare The blocks that were freed by reset(), which are reused before
+**              allocating new ones
+*/
+class Arena
+{
+private:
+    class Block
+    {
+    public:
+        Block *next;
+        uint_fast64_t size;
+    };
+
+    Block *head;
+    uint_fast64_t used;
+    uint_fast64_t block_size;
+    Block *spare;
+
+    Block *takeSpare(uint_fast64_t size);
+    void *allocBlock(uint_fast64_t size, uint_fast64_t align);
+
+public:
+    Arena(uint_fast64_t block_size = ARENA_BLOCK_SIZE);
+    ~Arena();
+
+    void adopt(Arena *other);
+    void reset();
+
+    /**
+    ** \returns A pointer to 'size' bytes aligned on 'align' (a power of 2)
+    */
+    void *alloc(uint_fast64_t size, uint_fast64_t align)
+    {
+        if (head != nullptr)
+        {
+            uint_fast64_t start = (used + align - 1) & ~(align - 1);
+            if (start + size <= head->size)
+            {
+                used = start + size;
+                return (char *)head + start;
+            }
+        }
+        return allocBlock(size, align);
+    }
+};
+
+/*******************************************************************************
+**                                 FUNCTIONS                                  **
+*******************************************************************************/
+/**
+** \brief Creates an object of class T in the given arena, or on the heap if the
+**        arena is a nullptr
+*/
+template <class T, class... Args>
+T *arena_new(Arena *arena, Args... args)
+{
+    if (arena == nullptr)
+    {
+        STATS_ALLOC(sizeof(T));
+        return new T(args...);
+    }
+    return new (arena->alloc(sizeof(T), alignof(T))) T(args...);
+}
+
+#endif // !ARENA_HPP
@@ -0,0 +1,146 @@
+#ifndef ARRAY_LIST_HPP
+#define ARRAY_LIST_HPP
+
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <cstring>
+#include <stdint.h>
+
+#include "arena.hpp"
+
+#define BASE_ARRAY_LEN 16
+
+/*******************************************************************************
+**                                   CLASSES                                  **
+*******************************************************************************/
+/**
+** \class ArrayList Contiguous and growable array of elements
+** \brief The elements are stored by value one after the other, so accessing
+**        one of them is O(1) and iterating over them is cache-friendly. When
+**        the number of elements is known in advance, reserve() allocates the
+**        exact capacity.
+**        The elements are moved with memcpy, so T must be trivially copyable.
+**        The list does not free what the elements point to, that is the job of
+**        its owner
+** \param arena The arena in which the array is allocated, nullptr if it is
+**              allocated on the heap
+** \param elts The elements
+** \param size The number of elements
+** \param capacity The number of elements that fit in 'elts'
+*/
+template <class T>
+class ArrayList
+{
+private:
+    Arena *arena = nullptr;
+    T *elts = nullptr;
+    uint_fast64_t size = 0;
+    uint_fast64_t capacity = 0;
+
+public:
+    ArrayList() {}
+    ArrayList(Arena *arena)
+        : arena(arena)
+    {}
+    ~ArrayList()
+    {
+        // The array of an arena is freed with it
+        if (arena == nullptr)
+        {
+            delete[] elts;
+        }
+    }
+
+    // A copy would share and free the same array
+    ArrayList(const ArrayList &) = delete;
+    ArrayList &operator=(const ArrayList &) = delete;
+
+    uint_fast64_t getSize()
+    {
+        return size;
+    }
+
+    /**
+    ** \returns A pointer on the element at the given index if it exists,
+    **          nullptr otherwise. It is invalidated when the list grows
+    */
+    T *get(uint_fast64_t index)
+    {
+        return index < size ? elts + index : nullptr;
+    }
+
+    /**
+    ** \returns The array of elements (not a copy), nullptr if the list is
+    **          empty. It is invalidated when the list grows
+    */
+    T *getArray()
+    {
+        return size == 0 ? nullptr : elts;
+    }
+
+    /**
+    ** \brief Makes sure that 'n' elements fit in the array without having to
+    **        grow it again
+    */
+    void reserve(uint_fast64_t n)
+    {
+        if (n <= capacity)
+        {
+            return;
+        }
+
+        if (arena == nullptr)
+        {
+            STATS_ALLOC(n * sizeof(T));
+        }
+        T *tmp = arena == nullptr
+            ? new T[n]
+            : (T *)arena->alloc(n * sizeof(T), alignof(T));
+        if (size > 0)
+        {
+            std::memcpy((void *)tmp, (void *)elts, size * sizeof(T));
+        }
+        if (arena == nullptr)
+        {
+            delete[] elts;
+        }
+        elts = tmp;
+        capacity = n;
+    }
+
+    /**
+    ** \brief Removes all the elements, but keeps the array for the next ones
+    */
+    void clear()
+    {
+        size = 0;
+    }
+
+    void add(T value)
+    {
+        if (size == capacity)
+        {
+            reserve(capacity < BASE_ARRAY_LEN ? BASE_ARRAY_LEN : capacity * 2);
+        }
+        elts[size++] = value;
+    }
+
+    /**
+    ** \brief Removes the element at the given index, the elements after it are
+    **        moved so that the array stays contiguous
+    */
+    void remove(uint_fast64_t index)
+    {
+        if (index >= size)
+        {
+            return;
+        }
+
+        std::memmove((void *)(elts + index), (void *)(elts + index + 1),
+                     (size - index - 1) * sizeof(T));
+        --size;
+    }
+};
+
+#endif // !ARRAY_LIST_HPP
@@ -0,0 +1,412 @@
+#include "cursor.hpp"
+
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "json_types.hpp"
+
+/*******************************************************************************
+**                                   CURSOR                                   **
+*******************************************************************************/
+/**
+** \brief Opens the given file, which is mapped in memory if it is a regular
+**        file, read through the window of the reader otherwise
+*/
+Cursor::Cursor(char *file)
+    : map(nullptr)
+    , map_size(0)
+    , f(nullptr)
+    , r(nullptr)
+    , token(TOKEN_END)
+    , started(false)
+    , err(0)
+    , key(nullptr)
+    , key_len(0)
+    , str(nullptr)
+    , str_len(0)
+    , i(0)
+    , d(0)
+    , b(false)
+{
+    int fd = file == nullptr ? -1 : open(file, O_RDONLY);
+    if (fd == -1)
+    {
+        return;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return;
+    }
+
+#ifndef DISABLE_MMAP
+    // Empty files can't be mapped
+    if (S_ISREG(st.st_mode) && st.st_size > 0)
+    {
+        void *m = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (m != MAP_FAILED)
+        {
+            // Only a hint to the kernel, so the error is ignored
+            madvise(m, st.st_size, MADV_SEQUENTIAL);
+            close(fd);
+            map = m;
+            map_size = st.st_size;
+            r = new Reader((const char *)m, map_size);
+            // The mapping stays alive as long as the cursor
+            r->retained = true;
+            start();
+            return;
+        }
+    }
+#endif
+
+    f = fdopen(fd, "r");
+    if (f == nullptr)
+    {
+        close(fd);
+        return;
+    }
+    r = new Reader(f);
+    start();
+}
+
+/**
+** \brief Reads the 'len' characters at 'buff', which must stay alive as long
+**        as the cursor
+*/
+Cursor::Cursor(const char *buff, uint_fast64_t len)
+    : map(nullptr)
+    , map_size(0)
+    , f(nullptr)
+    , r(buff == nullptr ? nullptr : new Reader(buff, len))
+    , token(TOKEN_END)
+    , started(false)
+    , err(0)
+    , key(nullptr)
+    , key_len(0)
+    , str(nullptr)
+    , str_len(0)
+    , i(0)
+    , d(0)
+    , b(false)
+{
+    if (r != nullptr)
+    {
+        r->retained = true;
+        start();
+    }
+}
+
+Cursor::~Cursor()
+{
+    delete r;
+    if (f != nullptr)
+    {
+        fclose(f);
+    }
+    if (map != nullptr)
+    {
+        munmap(map, map_size);
+    }
+}
+
+/**
+** \brief Moves the reader to the first token of the input
+*/
+void Cursor::start()
+{
+    if (r->index != nullptr)
+    {
+        // The first token is the first character that is not a whitespace
+        r->advance();
+    }
+}
+
+/**
+** \brief Sets the given error bits, after which the cursor only returns
+**        TOKEN_ERROR
+*/
+unsigned char Cursor::fail(uint_fast16_t err_bits)
+{
+    err |= err_bits;
+    token = TOKEN_ERROR;
+    return token;
+}
+
+/**
+** \brief Closes the innermost container, which must be an array if 'is_array'
+**        is true, a dict otherwise
+*/
+unsigned char Cursor::closeLevel(bool is_array)
+{
+    uint_fast64_t depth = levels.getSize();
+    Level *top = depth == 0 ? nullptr : levels.get(depth - 1);
+    if (top == nullptr || top->is_array != is_array || !top->canClose())
+    {
+        return fail(ERR_INVALID_JSON);
+    }
+
+    levels.remove(depth - 1);
+    token = is_array ? TOKEN_END_ARRAY : TOKEN_END_DICT;
+    return token;
+}
+
+bool Cursor::isValid()
+{
+    return r != nullptr;
+}
+
+/**
+** \brief Reads the next token of the input. If it is inside a dict, its key is
+**        read with it (see getKey())
+** \returns The type of the token (TOKEN_*)
+*/
+unsigned char Cursor::next()
+{
+    if (r == nullptr || token == TOKEN_ERROR)
+    {
+        return TOKEN_ERROR;
+    }
+    if (started && token == TOKEN_END)
+    {
+        return token;
+    }
+    if (started && levels.getSize() == 0)
+    {
+        // Only whitespaces can follow the root
+        if (!is_input_end(r))
+        {
+            return fail(ERR_INVALID_JSON);
+        }
+        token = TOKEN_END;
+        return token;
+    }
+
+    if (started)
+    {
+        r->advance();
+    }
+    started = true;
+    key = nullptr;
+    key_len = 0;
+
+    while (1)
+    {
+        if (r->pos >= r->len && !r->refill())
+        {
+            // The input ended before the root container was closed
+            return fail(ERR_INVALID_JSON);
+        }
+
+        char c = r->data[r->pos];
+        if (IS_WHITESPACE(c))
+        {
+            r->advance();
+            continue;
+        }
+
+        uint_fast64_t depth = levels.getSize();
+        Level *top = depth == 0 ? nullptr : levels.get(depth - 1);
+        if (top == nullptr && c != '[' && c != '{')
+        {
+            return fail(ERR_INVALID_JSON);
+        }
+
+        if (c == ',' || c == ':')
+        {
+            if (!top->readSeparator(c))
+            {
+                return fail(ERR_INVALID_JSON);
+            }
+            r->advance();
+            continue;
+        }
+
+        if (c == ']' || c == '}')
+        {
+            return closeLevel(c == ']');
+        }
+
+        // A dict that waits for a key only accepts a key or its end
+        if (top != nullptr && top->wantsKey())
+        {
+            if (c != '"')
+            {
+                return fail(ERR_NULL_KEY);
+            }
+
+            bool escaped = false;
+            if (!read_string(r, &keys, &key, &key_len, &escaped))
+            {
+                return fail(ERR_INVALID_JSON);
+            }
+            // The characters of a window are moved when it is refilled
+            if (!escaped && !r->retained)
+            {
+                char *copy = keys.reserve(key_len + 1);
+                std::memcpy(copy, key, key_len);
+                key = copy;
+            }
+            top->expect = EXPECT_COLON;
+            r->advance();
+            continue;
+        }
+
+        if (top != nullptr)
+        {
+            // A value that is not separated from the previous one
+            if (!top->wantsValue())
+            {
+                return fail(ERR_INVALID_JSON);
+            }
+            top->expect = EXPECT_COMMA;
+        }
+
+        if (c == '"')
+        {
+            bool escaped = false;
+            if (!read_string(r, &strs, &str, &str_len, &escaped))
+            {
+                return fail(ERR_INVALID_JSON);
+            }
+            token = TOKEN_STR;
+        }
+        else if (IS_NUMBER_START(c))
+        {
+            Number n;
+            if (!parse_number(r, &n) || !is_scalar_end(r))
+            {
+                return fail(ERR_INVALID_JSON);
+            }
+            i = n.i;
+            d = n.d;
+            token = n.is_float ? TOKEN_DOUBLE : TOKEN_INT;
+        }
+        else if (IS_BOOL_START(c)
+                 && (IS_LITERAL(r, "true", 4) || IS_LITERAL(r, "false", 5)))
+        {
+            b = c == 't';
+            r->pos += b ? 3 : 4;
+            if (!is_scalar_end(r))
+            {
+                return fail(ERR_INVALID_JSON);
+            }
+            token = TOKEN_BOOL;
+        }
+        else if (c == 'n' && IS_LITERAL(r, "null", 4))
+        {
+            r->pos += 3;
+            if (!is_scalar_end(r))
+            {
+                return fail(ERR_INVALID_JSON);
+            }
+            token = TOKEN_NULL;
+        }
+        else if (c == '[' || c == '{')
+        {
+            Level level;
+            level.is_array = c == '[';
+            level.expect = EXPECT_FIRST;
+            levels.add(level);
+            token = c == '[' ? TOKEN_START_ARRAY : TOKEN_START_DICT;
+        }
+        else
+        {
+            return fail(ERR_INVALID_JSON);
+        }
+        return token;
+    }
+}
+
+/**
+** \brief If the current token starts an array or a dict, moves past the whole
+**        container without reading its content (by matching its brackets), as
+**        if next() had been called until its end. The current token is then
+**        TOKEN_END_ARRAY or TOKEN_END_DICT. Does nothing for the other tokens
+** \returns false in case of error
+*/
+bool Cursor::skip()
+{
+    if (token != TOKEN_START_ARRAY && token != TOKEN_START_DICT)
+    {
+        return token != TOKEN_ERROR;
+    }
+
+    if (!skip_container(r))
+    {
+        fail(ERR_INVALID_JSON);
+        return false;
+    }
+    levels.remove(levels.getSize() - 1);
+    token = token == TOKEN_START_ARRAY ? TOKEN_END_ARRAY : TOKEN_END_DICT;
+    return true;
+}
+
+unsigned char Cursor::getToken()
+{
+    return token;
+}
+
+uint_fast16_t Cursor::getErr()
+{
+    return err;
+}
+
+/**
+** \returns The number of containers that are open
+*/
+uint_fast64_t Cursor::getDepth()
+{
+    return levels.getSize();
+}
+
+/**
+** \returns The key of the current token if it is in a dict, nullptr otherwise
+**          (not null terminated, see getKeyLen())
+*/
+const char *Cursor::getKey()
+{
+    return key;
+}
+
+uint_fast64_t Cursor::getKeyLen()
+{
+    return key_len;
+}
+
+/**
+** \returns The characters of the current TOKEN_STR (not null terminated, see
+**          getStrLen())
+*/
+const char *Cursor::getStr()
+{
+    return str;
+}
+
+uint_fast64_t Cursor::getStrLen()
+{
+    return str_len;
+}
+
+int_fast64_t Cursor::getInt()
+{
+    return i;
+}
+
+double Cursor::getDouble()
+{
+    return d;
+}
+
+bool Cursor::getBool()
+{
+    return b;
+}
@@ -0,0 +1,113 @@
+#ifndef CURSOR_HPP
+#define CURSOR_HPP
+
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <stdint.h>
+#include <stdio.h>
+
+#include "array_list.hpp"
+#include "reader.hpp"
+#include "scanner.hpp"
+
+/*******************************************************************************
+**                              DEFINES / MACROS                              **
+*******************************************************************************/
+#define TOKEN_END 0
+#define TOKEN_ERROR 1
+#define TOKEN_START_ARRAY 2
+#define TOKEN_END_ARRAY 3
+#define TOKEN_START_DICT 4
+#define TOKEN_END_DICT 5
+#define TOKEN_STR 6
+#define TOKEN_INT 7
+#define TOKEN_DOUBLE 8
+#define TOKEN_BOOL 9
+#define TOKEN_NULL 10
+
+/*******************************************************************************
+**                                   CLASSES                                  **
+*******************************************************************************/
+/**
+** \class Cursor Pull reader that reads a json array or dict one token at a
+**               time
+** \brief Each call to next() reads the next token of the input and returns its
+**        type (TOKEN_*), whose value is then available through the accessors.
+**        The keys of the dicts are not tokens : the key of a value (or of a
+**        nested container) is given by getKey() along with it.
+**        skip() moves past the whole container that was just started without
+**        reading its content, so only the parts of the input that are needed
+**        are parsed, and no json object is ever built.
+**        Regular files are mapped in memory (and indexed), the other streams
+**        (and all the files if DISABLE_MMAP is defined) are read through the
+**        window of the Reader, so the memory used does not depend on the size
+**        of the input.
+**        The strings (and the keys) are decoded, they are only valid until
+**        the next call to next() or skip().
+**        After the end of the root container, next() returns TOKEN_END (or
+**        TOKEN_ERROR if anything but whitespaces follows it). In case of
+**        error, it returns TOKEN_ERROR from then on
+** \param map The mapping of the file, nullptr if it is not mapped
+** \param map_size The size of the mapping
+** \param f The file stream read through the window of the reader, or nullptr
+** \param r The reader of the input, nullptr if the input could not be opened
+** \param levels The containers that are open, the last one being the
+**               innermost
+** \param keys The buffer in which the keys are copied, when they can't point
+**             into the input (escaped or read through a window)
+** \param strs The buffer in which the escaped strings are decoded
+** \param token The type of the current token
+** \param started Whether next() was already called (the reader is then on the
+**                last character of the current token)
+** \param err The error bits (see ERR_* in json_types.hpp)
+*/
+class Cursor
+{
+private:
+    void *map;
+    uint_fast64_t map_size;
+    FILE *f;
+    Reader *r;
+    ArrayList<Level> levels;
+    Scratch keys;
+    Scratch strs;
+    unsigned char token;
+    bool started;
+    uint_fast16_t err;
+
+    const char *key;
+    uint_fast64_t key_len;
+    const char *str;
+    uint_fast64_t str_len;
+    int_fast64_t i;
+    double d;
+    bool b;
+
+    void start();
+    unsigned char fail(uint_fast16_t err_bits);
+    unsigned char closeLevel(bool is_array);
+
+public:
+    Cursor(char *file);
+    Cursor(const char *buff, uint_fast64_t len);
+    ~Cursor();
+
+    bool isValid();
+    unsigned char next();
+    bool skip();
+
+    unsigned char getToken();
+    uint_fast16_t getErr();
+    uint_fast64_t getDepth();
+
+    const char *getKey();
+    uint_fast64_t getKeyLen();
+    const char *getStr();
+    uint_fast64_t getStrLen();
+    int_fast64_t getInt();
+    double getDouble();
+    bool getBool();
+};
+
+#endif // !CURSOR_HPP
@@ -0,0 +1,43 @@
+#ifndef HANDLER_HPP
+#define HANDLER_HPP
+
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+**                                   CLASSES                                  **
+*******************************************************************************/
+/**
+** \class Handler Receives the events of the parser, in the order of the input
+** \brief parse(file, handler) reads the input once and calls the handler for
+**        each token, without building any json object, so the memory it uses
+**        does not depend on the size of the input. The dicts send their keys
+**        with onKey(), followed by the event(s) of the value.
+**        The strings and keys are given with their escape sequences decoded.
+**        Their characters are only valid during the call, unless 'in_input' is
+**        true, in which case they point into the input of the parser (which
+**        only happens when the input is kept alive, like by a Document or by
+**        the caller of parse_buffer(chars, len, handler)).
+**        Each method returns false to stop the parsing
+*/
+class Handler
+{
+public:
+    virtual ~Handler() = default;
+
+    virtual bool onStartArray() = 0;
+    virtual bool onEndArray() = 0;
+    virtual bool onStartObject() = 0;
+    virtual bool onEndObject() = 0;
+    virtual bool onKey(const char *str, uint_fast64_t len, bool in_input) = 0;
+    virtual bool onString(const char *str, uint_fast64_t len,
+                          bool in_input) = 0;
+    virtual bool onInt(int_fast64_t i) = 0;
+    virtual bool onDouble(double d) = 0;
+    virtual bool onBool(bool b) = 0;
+    virtual bool onNull() = 0;
+};
+
+#endif // !HANDLER_HPP
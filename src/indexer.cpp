@@ -0,0 +1,351 @@
+#include "indexer.hpp"
+
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <cstring>
+
+#include "stats.hpp"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#    include <immintrin.h>
+#    define HAS_X86_KERNELS
+#endif
+
+/*******************************************************************************
+**                              DEFINES / MACROS                              **
+*******************************************************************************/
+/**
+** \def Number of positions needed to index a chunk of a buffer of 'len'
+**      characters : the positions are allocated for a whole chunk, or for the
+**      whole buffer if it is smaller (small buffers, like the containers parsed
+**      by LazyJSON, are indexed often)
+*/
+#define NB_CHUNK_POSITIONS(len)                                                \
+    (64                                                                        \
+     * ((len) / 64 < INDEX_CHUNK_BLOCKS ? (len) / 64 + 1 : INDEX_CHUNK_BLOCKS))
+
+/*******************************************************************************
+**                                 STRUCTURES                                 **
+*******************************************************************************/
+/**
+** \class BlockMasks
+** \brief The characters of a 64 characters block that are a '"', a '\', a
+**        whitespace or a structural character ('{', '}', '[', ']', ':' and
+**        ','), as bit masks (the bit i corresponds to the i-th character)
+*/
+class BlockMasks
+{
+public:
+    uint64_t quote;
+    uint64_t backslash;
+    uint64_t whitespace;
+    uint64_t op;
+};
+
+typedef void (*classify_fn)(const char *block, BlockMasks *m);
+
+/*******************************************************************************
+**                                  KERNELS                                   **
+*******************************************************************************/
+void classify_scalar(const char *block, BlockMasks *m)
+{
+    m->quote = 0;
+    m->backslash = 0;
+    m->whitespace = 0;
+    m->op = 0;
+    for (unsigned char i = 0; i < 64; ++i)
+    {
+        char c = block[i];
+        uint64_t bit = (uint64_t)1 << i;
+        if (c == '"')
+        {
+            m->quote |= bit;
+        }
+        else if (c == '\\')
+        {
+            m->backslash |= bit;
+        }
+        else if (c == ' ' || c == '\t' || c == '\n' || c == '\r')
+        {
+            m->whitespace |= bit;
+        }
+        else if (c == '{' || c == '}' || c == '[' || c == ']' || c == ':'
+                 || c == ',')
+        {
+            m->op |= bit;
+        }
+    }
+}
+
+#ifdef HAS_X86_KERNELS
+// '[' | 0x20 == '{' and ']' | 0x20 == '}', so the brackets and the braces are
+// found with the same 2 comparisons
+__attribute__((target("sse4.2"))) void classify_sse42(const char *block,
+                                                      BlockMasks *m)
+{
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lower = _mm_set1_epi8(0x20);
+    const __m128i open = _mm_set1_epi8('{');
+    const __m128i close = _mm_set1_epi8('}');
+    const __m128i colon = _mm_set1_epi8(':');
+    const __m128i comma = _mm_set1_epi8(',');
+
+    m->quote = 0;
+    m->backslash = 0;
+    m->whitespace = 0;
+    m->op = 0;
+    for (unsigned char i = 0; i < 4; ++i)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(block + 16 * i));
+        __m128i ws = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)),
+            _mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr)));
+        __m128i l = _mm_or_si128(v, lower);
+        __m128i op = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(l, open), _mm_cmpeq_epi8(l, close)),
+            _mm_or_si128(_mm_cmpeq_epi8(v, colon), _mm_cmpeq_epi8(v, comma)));
+
+        unsigned char shift = 16 * i;
+        m->quote |= (uint64_t)(uint16_t)_mm_movemask_epi8(
+                        _mm_cmpeq_epi8(v, quote))
+            << shift;
+        m->backslash |= (uint64_t)(uint16_t)_mm_movemask_epi8(
+                            _mm_cmpeq_epi8(v, backslash))
+            << shift;
+        m->whitespace |= (uint64_t)(uint16_t)_mm_movemask_epi8(ws) << shift;
+        m->op |= (uint64_t)(uint16_t)_mm_movemask_epi8(op) << shift;
+    }
+}
+
+__attribute__((target("avx2"))) void classify_avx2(const char *block,
+                                                   BlockMasks *m)
+{
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i lf = _mm256_set1_epi8('\n');
+    const __m256i cr = _mm256_set1_epi8('\r');
+    const __m256i lower = _mm256_set1_epi8(0x20);
+    const __m256i open = _mm256_set1_epi8('{');
+    const __m256i close = _mm256_set1_epi8('}');
+    const __m256i colon = _mm256_set1_epi8(':');
+    const __m256i comma = _mm256_set1_epi8(',');
+
+    m->quote = 0;
+    m->backslash = 0;
+    m->whitespace = 0;
+    m->op = 0;
+    for (unsigned char i = 0; i < 2; ++i)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(block + 32 * i));
+        __m256i ws = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, space),
+                            _mm256_cmpeq_epi8(v, tab)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, lf),
+                            _mm256_cmpeq_epi8(v, cr)));
+        __m256i l = _mm256_or_si256(v, lower);
+        __m256i op = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(l, open),
+                            _mm256_cmpeq_epi8(l, close)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, colon),
+                            _mm256_cmpeq_epi8(v, comma)));
+
+        unsigned char shift = 32 * i;
+        m->quote |= (uint64_t)(uint32_t)_mm256_movemask_epi8(
+                        _mm256_cmpeq_epi8(v, quote))
+            << shift;
+        m->backslash |= (uint64_t)(uint32_t)_mm256_movemask_epi8(
+                            _mm256_cmpeq_epi8(v, backslash))
+            << shift;
+        m->whitespace |= (uint64_t)(uint32_t)_mm256_movemask_epi8(ws)
+            << shift;
+        m->op |= (uint64_t)(uint32_t)_mm256_movemask_epi8(op) << shift;
+    }
+}
+#endif // HAS_X86_KERNELS
+
+/**
+** \returns The fastest kernel supported by the CPU
+*/
+classify_fn select_kernel()
+{
+#ifdef HAS_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return classify_avx2;
+    }
+    if (__builtin_cpu_supports("sse4.2"))
+    {
+        return classify_sse42;
+    }
+#endif
+    return classify_scalar;
+}
+
+/*******************************************************************************
+**                              LOCAL FUNCTIONS                               **
+*******************************************************************************/
+/**
+** \brief Finds the characters that are escaped by an odd number of '\'
+** \param backslash The mask of the '\' of the block
+** \param prev_escaped Whether the first character of the block is escaped by
+**                     the previous block. Updated for the next block
+** \returns The mask of the escaped characters
+*/
+uint64_t find_escaped(uint64_t backslash, uint64_t *prev_escaped)
+{
+    const uint64_t even_bits = 0x5555555555555555ULL;
+    const uint64_t odd_bits = ~even_bits;
+
+    uint64_t start_edges = backslash & ~(backslash << 1);
+    // A sequence continuing from the previous block changes the parity
+    uint64_t even_start_mask = even_bits ^ *prev_escaped;
+    uint64_t even_starts = start_edges & even_start_mask;
+    uint64_t odd_starts = start_edges & ~even_start_mask;
+
+    uint64_t even_carries = backslash + even_starts;
+    uint64_t odd_carries = backslash + odd_starts;
+    bool ends_odd = odd_carries < backslash;
+    odd_carries |= *prev_escaped;
+    *prev_escaped = ends_odd ? 1 : 0;
+
+    uint64_t even_carry_ends = even_carries & ~backslash;
+    uint64_t odd_carry_ends = odd_carries & ~backslash;
+    return (even_carry_ends & odd_bits) | (odd_carry_ends & even_bits);
+}
+
+/**
+** \returns The mask where each bit is the xor of itself and all the bits
+**          before it
+*/
+uint64_t prefix_xor(uint64_t bits)
+{
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+/*******************************************************************************
+**                              STRUCTURAL INDEX                              **
+*******************************************************************************/
+StructuralIndex::StructuralIndex(const char *data, uint_fast64_t len)
+    : data(data)
+    , len(len)
+    , block_idx(0)
+    , prev_escaped(0)
+    , prev_in_string(0)
+    , prev_scalar(0)
+    , positions(new uint_fast64_t[NB_CHUNK_POSITIONS(len)])
+    , capacity(NB_CHUNK_POSITIONS(len))
+    , nb_positions(0)
+    , next_pos(0)
+{
+    STATS_ALLOC(capacity * sizeof(uint_fast64_t));
+}
+
+StructuralIndex::~StructuralIndex()
+{
+    delete[] positions;
+}
+
+/**
+** \brief Starts indexing another buffer, reusing the positions if they are
+**        large enough for its chunks
+*/
+void StructuralIndex::reset(const char *data, uint_fast64_t len)
+{
+    this->data = data;
+    this->len = len;
+    block_idx = 0;
+    prev_escaped = 0;
+    prev_in_string = 0;
+    prev_scalar = 0;
+    nb_positions = 0;
+    next_pos = 0;
+
+    if (capacity < NB_CHUNK_POSITIONS(len))
+    {
+        delete[] positions;
+        capacity = NB_CHUNK_POSITIONS(len);
+        STATS_ALLOC(capacity * sizeof(uint_fast64_t));
+        positions = new uint_fast64_t[capacity];
+    }
+}
+
+/**
+** \brief Classifies the given block of 64 characters
+** \returns The mask of the tokens of the block
+*/
+uint64_t StructuralIndex::indexBlock(const char *block)
+{
+    static const classify_fn classify = select_kernel();
+
+    BlockMasks m;
+    classify(block, &m);
+
+    uint64_t escaped = find_escaped(m.backslash, &prev_escaped);
+    uint64_t quote = m.quote & ~escaped;
+
+    // The opening '"' is inside the string and the closing one is outside
+    uint64_t in_string = prefix_xor(quote) ^ prev_in_string;
+    prev_in_string = (uint64_t)((int64_t)in_string >> 63);
+
+    uint64_t scalar = ~(m.op | m.whitespace | quote | in_string);
+    uint64_t scalar_starts = scalar & ~((scalar << 1) | prev_scalar);
+    prev_scalar = scalar >> 63;
+
+    return (m.op & ~in_string) | quote | scalar_starts;
+}
+
+/**
+** \brief Indexes the next INDEX_CHUNK_BLOCKS blocks of the buffer
+** \returns false if the whole buffer was already indexed
+*/
+bool StructuralIndex::indexChunk()
+{
+    if (block_idx >= len)
+    {
+        return false;
+    }
+
+    STATS_START(start);
+    nb_positions = 0;
+    next_pos = 0;
+    for (uint_fast64_t b = 0; b < INDEX_CHUNK_BLOCKS && block_idx < len; ++b)
+    {
+        uint64_t tokens = 0;
+        if (len - block_idx >= 64)
+        {
+            tokens = indexBlock(data + block_idx);
+        }
+        else
+        {
+            // The last block is padded with whitespaces
+            char block[64];
+            std::memset(block, ' ', 64);
+            std::memcpy(block, data + block_idx, len - block_idx);
+            tokens = indexBlock(block);
+        }
+
+        while (tokens != 0)
+        {
+            positions[nb_positions++] = block_idx + __builtin_ctzll(tokens);
+            tokens &= tokens - 1;
+        }
+        block_idx += 64;
+    }
+    STATS_STOP(index_ns, start);
+    return true;
+}
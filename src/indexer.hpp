@@ -0,0 +1,92 @@
+#ifndef INDEXER_HPP
+#define INDEXER_HPP
+
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+**                              DEFINES / MACROS                              **
+*******************************************************************************/
+/**
+** \def Number of 64 characters blocks that are indexed at once, the positions
+**      of a chunk are consumed before the next chunk is indexed
+*/
+#ifndef INDEX_CHUNK_BLOCKS
+#    define INDEX_CHUNK_BLOCKS 256
+#endif
+
+/*******************************************************************************
+**                                   CLASSES                                  **
+*******************************************************************************/
+/**
+** \class StructuralIndex
+** \brief Finds the positions of the tokens of a buffer, 64 characters at a time
+**        (using AVX2 or SSE4.2 when the CPU supports them). The indexed
+**        positions are the structural characters ('{', '}', '[', ']', ':' and
+**        ',') that are not inside a string, the '"' that begin and end the
+**        strings and the first character of the other values (numbers,
+**        booleans and null). The whitespaces and the characters inside strings
+**        are never part of the index, so the parser can jump from one token to
+**        the next instead of reading every character.
+**        The buffer is indexed by chunks of INDEX_CHUNK_BLOCKS blocks, while the
+**        positions are consumed
+** \param data The buffer that is indexed
+** \param len The number of characters of the buffer
+** \param block_idx The index of the first character that is not yet indexed
+** \param prev_escaped Whether the first character of the next block is
+**                     escaped by the last '\' of the previous one
+** \param prev_in_string All ones if the previous block ended inside a string,
+**                       0 otherwise
+** \param prev_scalar Whether the previous block ended with a character that
+**                    is part of a number or a literal
+** \param positions The positions of the current chunk
+** \param capacity The number of positions that fit in 'positions'
+** \param nb_positions The number of positions of the current chunk
+** \param next_pos The index in 'positions' of the next position to return
+*/
+class StructuralIndex
+{
+private:
+    const char *data;
+    uint_fast64_t len;
+    uint_fast64_t block_idx;
+
+    uint64_t prev_escaped;
+    uint64_t prev_in_string;
+    uint64_t prev_scalar;
+
+    uint_fast64_t *positions;
+    uint_fast64_t capacity;
+    uint_fast64_t nb_positions;
+    uint_fast64_t next_pos;
+
+    uint64_t indexBlock(const char *block);
+    bool indexChunk();
+
+public:
+    StructuralIndex(const char *data, uint_fast64_t len);
+    ~StructuralIndex();
+
+    void reset(const char *data, uint_fast64_t len);
+
+    /**
+    ** \brief Puts in 'pos' the position of the next token
+    ** \returns false if there are no more tokens in the buffer
+    */
+    bool next(uint_fast64_t *pos)
+    {
+        while (next_pos == nb_positions)
+        {
+            if (!indexChunk())
+            {
+                return false;
+            }
+        }
+        *pos = positions[next_pos++];
+        return true;
+    }
+};
+
+#endif // !INDEXER_HPP
@@ -3,642 +3,762 @@
 /*******************************************************************************
 **                                  INCLUDES                                  **
 *******************************************************************************/
-#include <iomanip>
+#include <cstring>
 #include <iostream>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "key_table.hpp"
+#include "parser.hpp"
+#include "serializer.hpp"
 
 using namespace std;
 
 /*******************************************************************************
 **                                   VALUES                                   **
 *******************************************************************************/
-/**************************************
-**            STRING VALUE           **
-**************************************/
-StringValue::StringValue(String *value)
-    : Value(T_STR)
-    , value(value)
+Value::Value()
+    : type(T_NULL)
+    , lazy(false)
+    , i(0)
 {}
 
-StringValue::~StringValue()
+Value Value::fromInt(int_fast64_t i)
 {
-    delete value;
+    Value v;
+    v.type = T_INT;
+    v.i = i;
+    return v;
 }
 
-String *StringValue::getValue()
+Value Value::fromDouble(double d)
 {
-    return value;
+    Value v;
+    v.type = T_DOUBLE;
+    v.d = d;
+    return v;
 }
 
-void StringValue::printNoFlush()
+Value Value::fromBool(bool b)
 {
-    cout << "\"" << (value == nullptr ? "" : value->str()) << "\"";
+    Value v;
+    v.type = T_BOOL;
+    v.b = b;
+    return v;
 }
 
-/**************************************
-**             INT VALUE             **
-**************************************/
-IntValue::IntValue(int_fast64_t value)
-    : Value(T_INT)
-    , value(value)
-{}
-
-int_fast64_t IntValue::getValue()
+Value Value::fromString(String *s)
 {
-    return value;
+    Value v;
+    v.type = T_STR;
+    v.s = s;
+    return v;
 }
 
-void IntValue::printNoFlush()
+Value Value::fromArray(JSONArray *ja)
 {
-    cout << value;
+    Value v;
+    v.type = T_ARR;
+    v.ja = ja;
+    return v;
 }
 
-/**************************************
-**           DOUBLE VALUE            **
-**************************************/
-DoubleValue::DoubleValue(double value)
-    : Value(T_DOUBLE)
-    , value(value)
-{}
-
-double DoubleValue::getValue()
+Value Value::fromDict(JSONDict *jd)
 {
-    return value;
+    Value v;
+    v.type = T_DICT;
+    v.jd = jd;
+    return v;
 }
 
-void DoubleValue::printNoFlush()
+Value Value::fromLazy(LazyJSON *lj)
 {
-    cout << setprecision(16) << value;
+    Value v;
+    v.type = lj->isArray() ? T_ARR : T_DICT;
+    v.lazy = true;
+    v.lj = lj;
+    return v;
 }
 
-/**************************************
-**             BOOL VALUE            **
-**************************************/
-BoolValue::BoolValue(bool value)
-    : Value(T_BOOL)
-    , value(value)
-{}
-
-bool BoolValue::getValue()
+unsigned char Value::getType()
 {
-    return value;
+    return type;
 }
 
-void BoolValue::printNoFlush()
+bool Value::isLazy()
 {
-    cout << (value ? "true" : "false");
+    return lazy;
 }
 
-/**************************************
-**             NULL VALUE            **
-**************************************/
-NullValue::NullValue()
-    : Value(T_NULL)
-{}
-
-void NullValue::printNoFlush()
+int_fast64_t Value::getInt()
 {
-    cout << "null";
+    return type == T_INT ? i : 0;
 }
 
-/**************************************
-**            ARRAY VALUE            **
-**************************************/
-ArrayValue::ArrayValue(JSONArray *ja_arg)
-    : Value(T_ARR)
-    , ja(ja_arg)
-{}
-
-ArrayValue::~ArrayValue()
+double Value::getDouble()
 {
-    delete ja;
+    return type == T_DOUBLE ? d : 0;
 }
 
-JSONArray *ArrayValue::getValue()
+bool Value::getBool()
 {
-    return ja;
+    return type == T_BOOL ? b : false;
 }
 
-void ArrayValue::printNoFlush()
+String *Value::getString()
 {
-    print();
+    return type == T_STR ? s : nullptr;
 }
 
-void ArrayValue::print()
+/**
+** \returns The array, parsed first if it is lazy (nullptr if it is not an
+**          array, or if the content of the lazy array is invalid)
+*/
+JSONArray *Value::getArray()
 {
-    if (ja != nullptr)
+    if (type != T_ARR)
     {
-        ja->printValues();
+        return nullptr;
     }
+    return lazy ? (JSONArray *)lj->get() : ja;
 }
 
-/**************************************
-**            DICT VALUE             **
-**************************************/
-DictValue::DictValue(JSONDict *jd_arg)
-    : Value(T_DICT)
-    , jd(jd_arg)
-{}
-
-DictValue::~DictValue()
+/**
+** \returns The dict, parsed first if it is lazy (nullptr if it is not a dict,
+**          or if the content of the lazy dict is invalid)
+*/
+JSONDict *Value::getDict()
 {
-    delete jd;
+    if (type != T_DICT)
+    {
+        return nullptr;
+    }
+    return lazy ? (JSONDict *)lj->get() : jd;
 }
 
-JSONDict *DictValue::getValue()
+/**
+** \brief Frees the string, array or dict pointed to by the value (only for
+**        values that are not allocated in an arena), the value becomes null
+*/
+void Value::destroy()
 {
-    return jd;
+    if (lazy)
+    {
+        delete lj;
+        lazy = false;
+        type = T_NULL;
+        return;
+    }
+
+    switch (type)
+    {
+    case T_STR:
+        delete s;
+        break;
+    case T_ARR:
+        delete ja;
+        break;
+    case T_DICT:
+        delete jd;
+        break;
+    default:
+        break;
+    }
+    type = T_NULL;
 }
 
-void DictValue::printNoFlush()
+/**
+** \brief Prints the value on the standard output (arrays and dicts are
+**        followed by a newline)
+*/
+void Value::print()
 {
-    print();
+    cout.flush();
+    Serializer serializer(STDOUT_FILENO, true);
+    serializer.writeValue(this);
+    if (type == T_ARR || type == T_DICT)
+    {
+        serializer.writeChar('\n');
+    }
 }
 
-void DictValue::print()
+/**
+** \returns The error bit of the value if it is a string, array or dict that
+**          is a nullptr, 0 otherwise
+*/
+static uint_fast16_t check_value(Value *value)
 {
-    if (jd != nullptr)
+    switch (value->getType())
     {
-        jd->printItems();
+    case T_STR:
+        return value->getString() == nullptr ? ERR_NULL_STR : 0;
+    // The lazy containers are not parsed to be checked
+    case T_ARR:
+        return value->isLazy() || value->getArray() != nullptr ? 0
+                                                               : ERR_NULL_ARR;
+    case T_DICT:
+        return value->isLazy() || value->getDict() != nullptr ? 0
+                                                              : ERR_NULL_DICT;
+    default:
+        return 0;
     }
 }
 
 /*******************************************************************************
 **                                   ITEMS                                    **
 *******************************************************************************/
-/**************************************
-**            STRING ITEM            **
-**************************************/
-StringItem::StringItem(String *key, String *value)
-    : Item(key, T_STR)
-    , value(value)
+Item::Item()
+    : key(nullptr)
+    , value()
 {}
 
-StringItem::~StringItem()
-{
-    delete value;
-}
-
-String *StringItem::getValue()
-{
-    return value;
-}
-
-void StringItem::printNoFlush()
-{
-    printKey();
-    cout << "\"" << (value == nullptr ? "" : value->str()) << "\"";
-}
-
-/**************************************
-**             INT ITEM              **
-**************************************/
-IntItem::IntItem(String *key, int_fast64_t value)
-    : Item(key, T_INT)
+Item::Item(String *key, Value value)
+    : key(key)
     , value(value)
 {}
 
-int_fast64_t IntItem::getValue()
+String *Item::getKey()
 {
-    return value;
+    return key;
 }
 
-void IntItem::printNoFlush()
+Value *Item::getValue()
 {
-    printKey();
-    cout << value;
+    return &value;
 }
 
-/**************************************
-**           DOUBLE ITEM             **
-**************************************/
-DoubleItem::DoubleItem(String *key, double value)
-    : Item(key, T_DOUBLE)
-    , value(value)
+/*******************************************************************************
+**                                    JSON                                    **
+*******************************************************************************/
+JSON::JSON(bool is_array, Arena *arena)
+    : is_array(is_array)
+    , arena(arena)
 {}
 
-double DoubleItem::getValue()
+bool JSON::isArray()
 {
-    return value;
+    return is_array;
 }
 
-void DoubleItem::printNoFlush()
+Arena *JSON::getArena()
 {
-    printKey();
-    cout << setprecision(16) << value;
+    return arena;
 }
 
-/**************************************
-**             BOOL ITEM             **
-**************************************/
-BoolItem::BoolItem(String *key, bool value)
-    : Item(key, T_BOOL)
-    , value(value)
-{}
-
-bool BoolItem::getValue()
+/**
+** \brief Prints the json object on the standard output, followed by a newline.
+**        The compact output has no whitespace and is built entirely in memory
+**        before being written at once, the pretty one is written each time
+**        the buffer of the serializer is full
+*/
+void JSON::print(bool compact)
 {
-    return value;
-}
-
-void BoolItem::printNoFlush()
-{
-    printKey();
-    cout << (value ? "true" : "false");
+#ifndef VALGRING_DISABLE_PRINT
+    cout.flush();
+    if (compact)
+    {
+        Serializer serializer(false);
+        serializer.writeJSON(this);
+        serializer.writeChar('\n');
+        serializer.writeTo(STDOUT_FILENO);
+    }
+    else
+    {
+        Serializer serializer(STDOUT_FILENO, true);
+        serializer.writeJSON(this);
+        serializer.writeChar('\n');
+    }
+#else
+    (void)compact;
+#endif
 }
 
 /**************************************
-**             NULL ITEM             **
+**              ARRAY                **
 **************************************/
-NullItem::NullItem(String *key)
-    : Item(key, T_NULL)
+JSONArray::JSONArray(Arena *arena)
+    : JSON(true, arena)
+    , values(arena)
 {}
 
-void NullItem::printNoFlush()
+JSONArray::~JSONArray()
 {
-    printKey();
-    cout << "null";
-}
-
-/**************************************
-**            ARRAY ITEM             **
-**************************************/
-ArrayItem::ArrayItem(String *key, JSONArray *ja_arg)
-    : Item(key, T_ARR)
-    , ja(ja_arg)
-{}
+    // The content of an arena is freed with it
+    if (getArena() != nullptr)
+    {
+        return;
+    }
 
-ArrayItem::~ArrayItem()
-{
-    delete ja;
+    uint_fast64_t size = getSize();
+    for (uint_fast64_t i = 0; i < size; ++i)
+    {
+        values.get(i)->destroy();
+    }
 }
 
-JSONArray *ArrayItem::getValue()
+uint64_t JSONArray::getSize()
 {
-    return ja;
+    return values.getSize();
 }
 
-void ArrayItem::printNoFlush()
+/**
+** \brief Allocates the space for 'n' values, used when the number of values is
+**        known before adding them
+*/
+void JSONArray::reserve(uint_fast64_t n)
 {
-    print();
+    values.reserve(n);
 }
 
-void ArrayItem::print()
+uint_fast16_t JSONArray::addValue(Value value)
 {
-    if (ja != nullptr)
+    uint_fast16_t err = check_value(&value);
+    if (err)
     {
-        ja->printValues();
+        return err;
     }
-}
 
-/**************************************
-**             DICT ITEM             **
-**************************************/
-DictItem::DictItem(String *key, JSONDict *jd_arg)
-    : Item(key, T_DICT)
-    , jd(jd_arg)
-{}
-
-DictItem::~DictItem()
-{
-    delete jd;
+    values.add(value);
+    return 0;
 }
 
-JSONDict *DictItem::getValue()
+/**
+** \returns The values of the array (not a copy), they are invalidated when a
+**          value is added
+*/
+Value *JSONArray::getValues()
 {
-    return jd;
+    return values.getArray();
 }
 
-void DictItem::printNoFlush()
+Value *JSONArray::getValueAt(uint_fast64_t index)
 {
-    print();
+    return values.get(index);
 }
 
-void DictItem::print()
+void JSONArray::printValues(bool compact)
 {
-    if (jd != nullptr)
-    {
-        jd->printItems();
-    }
+    print(compact);
 }
 
-/*******************************************************************************
-**                                    JSON                                    **
-*******************************************************************************/
-JSON::JSON(bool is_array)
-    : is_array(is_array)
+/**************************************
+**               DICT                **
+**************************************/
+JSONDict::JSONDict(Arena *arena, KeyTable *keys)
+    : JSON(false, arena)
+    , items(arena)
+    , index(nullptr)
+    , index_capacity(0)
+    , keys(keys)
 {}
 
-bool JSON::isArray()
+JSONDict::~JSONDict()
 {
-    return is_array;
+    // The content of an arena is freed with it
+    if (getArena() != nullptr)
+    {
+        return;
+    }
+
+    uint_fast64_t size = getSize();
+    for (uint_fast64_t i = 0; i < size; ++i)
+    {
+        Item *it = items.get(i);
+        delete it->getKey();
+        it->getValue()->destroy();
+    }
+    delete[] index;
 }
 
-/**************************************
-**              ARRAY                **
-**************************************/
-JSONArray::JSONArray()
-    : JSON(true)
+uint64_t JSONDict::getSize()
 {
-    values = LinkedList<Value>();
+    return items.getSize();
 }
 
-JSONArray::~JSONArray()
-{}
-
-uint64_t JSONArray::getSize()
+/**
+** \brief Allocates the space for 'n' items, used when the number of items is
+**        known before adding them
+*/
+void JSONDict::reserve(uint_fast64_t n)
 {
-    return values.getSize();
+    items.reserve(n);
+    if (n >= DICT_INDEX_MIN_SIZE && n * 2 > index_capacity)
+    {
+        buildIndex(n);
+    }
 }
 
-uint_fast16_t JSONArray::addValue(Value *value)
+/**
+** \brief (Re)allocates the index with enough slots for 'n' items (the load
+**        factor is kept under 1/2) and inserts the current items in it
+*/
+void JSONDict::buildIndex(uint_fast64_t n)
 {
-    if (value == nullptr)
+    uint_fast64_t capacity = BASE_ARRAY_LEN;
+    while (capacity < n * 2)
     {
-        return ERR_NULL_VALUE;
+        capacity *= 2;
     }
 
-    if (IS_STRING(value) && ((StringValue *)value)->getValue() == nullptr)
+    Arena *arena = getArena();
+    if (arena == nullptr)
     {
-        delete value;
-        return ERR_NULL_STR;
+        delete[] index;
+        STATS_ALLOC(capacity * sizeof(uint_fast64_t));
+        index = new uint_fast64_t[capacity]();
     }
-
-    if (IS_ARR(value) && ((ArrayValue *)value)->getValue() == nullptr)
+    else
     {
-        delete value;
-        return ERR_NULL_ARR;
+        index = (uint_fast64_t *)arena->alloc(capacity * sizeof(uint_fast64_t),
+                                              alignof(uint_fast64_t));
+        memset(index, 0, capacity * sizeof(uint_fast64_t));
     }
+    index_capacity = capacity;
 
-    if (IS_DICT(value) && ((DictValue *)value)->getValue() == nullptr)
+    uint_fast64_t size = items.getSize();
+    for (uint_fast64_t i = 0; i < size; ++i)
     {
-        delete value;
-        return ERR_NULL_DICT;
+        indexItem(i);
     }
-
-    values.add(value);
-    return 0;
 }
 
-Value **JSONArray::getValues()
+/**
+** \brief Inserts the item at position 'pos' in the index (linear probing)
+*/
+void JSONDict::indexItem(uint_fast64_t pos)
 {
-    return values.getAsArray();
+    String *key = items.get(pos)->getKey();
+    uint_fast64_t mask = index_capacity - 1;
+    uint_fast64_t slot = hash_str(key->str(), key->len()) & mask;
+    while (index[slot] != 0)
+    {
+        slot = (slot + 1) & mask;
+    }
+    index[slot] = pos + 1;
 }
 
-Value *JSONArray::getValueAt(uint_fast64_t index)
+/**
+** \brief Searches the item whose key is the given String, comparing the keys
+**        by address (only used with interned keys)
+** \param hash The hash of the key, only used if the dict has an index
+*/
+Item *JSONDict::findKey(String *key, uint_fast64_t hash)
 {
-    return values.get(index);
+    if (index == nullptr)
+    {
+        uint_fast64_t size = getSize();
+        for (uint_fast64_t i = 0; i < size; ++i)
+        {
+            Item *it = items.get(i);
+            if (it->getKey() == key)
+            {
+                return it;
+            }
+        }
+        return nullptr;
+    }
+
+    uint_fast64_t mask = index_capacity - 1;
+    uint_fast64_t slot = hash & mask;
+    while (index[slot] != 0)
+    {
+        Item *it = items.get(index[slot] - 1);
+        if (it->getKey() == key)
+        {
+            return it;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return nullptr;
 }
 
-void JSONArray::printValues()
+/**
+** \brief Adds the (key, value) pair at the end of the dict, which then owns
+**        both of them. If the key already exists in the dict, or in case of
+**        error, the pair is not added (and is freed if the dict is not in an
+**        arena). If the dict has a KeyTable, the key is interned in it and the
+**        dict keeps the interned String instead. The given String is then not
+**        freed by the dict, it stays owned by the caller (or by its arena)
+** \returns The error bits
+*/
+uint_fast16_t JSONDict::addItem(String *key, Value value)
 {
-#ifndef VALGRING_DISABLE_PRINT
-    printValuesIndent(1, false);
-#endif
+    // A String that is not the interned one would not be equal to any key
+    if (keys != nullptr && key != nullptr)
+    {
+        key = keys->intern(key->str(), key->len(), false);
+    }
+    return addInternedItem(key, value);
 }
 
-void JSONArray::printValuesIndent(int indent, bool fromDict)
+/**
+** \brief Same as addItem(), for a key that is already interned in the KeyTable
+**        of the dict if it has one (like the keys given by the parser), so it
+**        is not looked up in it again
+** \returns The error bits
+*/
+uint_fast16_t JSONDict::addInternedItem(String *key, Value value)
 {
-    // Obtains the number of tab characters that will be printed
-    char *tabs = new char[indent]();
-    if (tabs == nullptr)
+    uint_fast16_t err = key == nullptr ? ERR_NULL_KEY : check_value(&value);
+    bool exists = false;
+    if (!err)
     {
-        return;
+        exists = keys == nullptr
+            ? getItem(key->str(), key->len()) != nullptr
+            : findKey(key,
+                      index == nullptr ? 0 : hash_str(key->str(), key->len()))
+                != nullptr;
     }
-    for (int i = 0; i < indent - 1; ++i)
+    // If an item with the same key already exists we don't add the item
+    if (exists)
     {
-        tabs[i] = '\t';
+#ifdef DEBUG
+        cout << "The item with key '";
+        cout.write(key->str(), key->len());
+        cout << "' already exists, not adding it and freeing allocated "
+                "memory. (Existing item : '";
+        getItem(key)->getValue()->print();
+        cout << "')" << endl;
+#endif
+        err = ERR_ITEM_EXISTS;
     }
-    tabs[indent - 1] = '\0';
 
-    uint_fast64_t size = getSize();
-    // Empty array
-    if (size == 0)
+    if (err)
     {
-        cout << (fromDict ? "" : tabs) << "[]";
-        if (indent == 1)
+        if (getArena() == nullptr)
         {
-            cout << endl;
+            delete key;
+            value.destroy();
         }
-        delete[] tabs;
-        return;
+        return err;
     }
 
-    cout << (fromDict ? "" : tabs) << "[\n";
+    items.add(Item(key, value));
 
-    for (uint_fast64_t i = 0; i < size; ++i)
+    uint_fast64_t size = items.getSize();
+    if (index != nullptr && size * 2 <= index_capacity)
     {
-        Value *value = values.get(i);
-        if (value == nullptr)
-        {
-            continue;
-        }
-
-        if (IS_ARR(value))
-        {
-            JSONArray *j = ((ArrayValue *)value)->getValue();
-            if (j != nullptr)
-            {
-                j->printValuesIndent(indent + 1, false);
-            }
-        }
-        else if (IS_DICT(value))
-        {
-            JSONDict *jd = ((DictValue *)value)->getValue();
-            if (jd != nullptr)
-            {
-                jd->printItemsIndent(indent + 1, false);
-            }
-        }
-        else
-        {
-            cout << "\t" << tabs;
-            value->printNoFlush();
-        }
-
-        if (i < size - 1)
-        {
-            cout << ",\n";
-        }
+        indexItem(size - 1);
     }
-
-    cout << "\n" << tabs << "]";
-
-    if (indent == 1)
+    else if (size >= DICT_INDEX_MIN_SIZE)
     {
-        cout << endl;
+        buildIndex(size * 2);
     }
-    delete[] tabs;
-}
-
-/**************************************
-**               DICT                **
-**************************************/
-JSONDict::JSONDict()
-    : JSON(false)
-{
-    items = LinkedList<Item>();
+    return 0;
 }
 
-JSONDict::~JSONDict()
-{}
-
-uint64_t JSONDict::getSize()
+/**
+** \returns The items of the dict (not a copy), they are invalidated when an
+**          item is added
+*/
+Item *JSONDict::getItems()
 {
-    return items.getSize();
+    return items.getArray();
 }
 
-uint_fast16_t JSONDict::addItem(Item *item)
+/**
+** \brief Searches the item with the given key. If the keys of the dict are
+**        interned and 'key' is one of them, they are only compared by address
+*/
+Item *JSONDict::getItem(String *key)
 {
-    if (item == nullptr)
+    if (key == nullptr || key->str() == nullptr)
     {
-        return ERR_NULL_ITEM;
+        return nullptr;
     }
-
-    if (item->getKey() == nullptr)
+    if (keys == nullptr)
     {
-        delete item;
-        return ERR_NULL_KEY;
+        return getItem(key->str(), key->len());
     }
 
-    if (IS_STRING(item) && ((StringItem *)item)->getValue() == nullptr)
+    uint_fast64_t hash = hash_str(key->str(), key->len());
+    Item *it = findKey(key, hash);
+    if (it != nullptr)
     {
-        delete item;
-        return ERR_NULL_STR;
+        return it;
     }
-
-    if (IS_ARR(item) && ((ArrayItem *)item)->getValue() == nullptr)
+    // The key may be another String with the same characters as an interned
+    // key
+    String *k = keys->find(key->str(), key->len(), hash);
+    return k == nullptr || k == key ? nullptr : findKey(k, hash);
+}
+
+/**
+** \brief Searches the item whose key has the given bytes, through the index
+**        if the dict has one, linearly otherwise. If the keys of the dict are
+**        interned, the key is first searched in the KeyTable (a key that no
+**        dict of the document has is found missing there), and then compared
+**        by address
+** \param key The bytes of the key (not necessarily null terminated)
+** \param len The number of bytes of the key
+** \returns The item or nullptr if there is no such key in the dict
+*/
+Item *JSONDict::getItem(const char *key, uint_strlen_t len)
+{
+    return getItem(key, len,
+                   index == nullptr && keys == nullptr ? 0
+                                                       : hash_str(key, len));
+}
+
+/**
+** \brief Same as getItem(key, len), for a key whose hash was computed in
+**        advance (it must be hash_str(key, len))
+*/
+Item *JSONDict::getItem(const char *key, uint_strlen_t len, uint_fast64_t hash)
+{
+    if (keys != nullptr)
     {
-        delete item;
-        return ERR_NULL_ARR;
+        String *k = keys->find(key, len, hash);
+        return k == nullptr ? nullptr : findKey(k, hash);
     }
 
-    if (IS_DICT(item) && ((DictItem *)item)->getValue() == nullptr)
+    if (index == nullptr)
     {
-        delete item;
-        return ERR_NULL_DICT;
+        uint_fast64_t size = getSize();
+        for (uint_fast64_t i = 0; i < size; ++i)
+        {
+            Item *it = items.get(i);
+            String *k = it->getKey();
+            if (k->len() == len && memcmp(k->str(), key, len) == 0)
+            {
+                return it;
+            }
+        }
+        return nullptr;
     }
 
-    // If an item with the same key already exists we don't add the item
-    if (getItem(item->getKey()) != nullptr)
+    uint_fast64_t mask = index_capacity - 1;
+    uint_fast64_t slot = hash & mask;
+    while (index[slot] != 0)
     {
-#ifdef DEBUG
-        cout << "The item with key '" << item->getKey()->str()
-             << "' already exists, not adding it and freeing allocated "
-                "memory. (Existing item : '"
-             << item->getKey()->str() << ": ";
-        getItem(item->getKey())->print();
-        cout << endl;
-#endif
-        delete item;
-        return ERR_ITEM_EXISTS;
+        Item *it = items.get(index[slot] - 1);
+        String *k = it->getKey();
+        if (k->len() == len && memcmp(k->str(), key, len) == 0)
+        {
+            return it;
+        }
+        slot = (slot + 1) & mask;
     }
-
-    items.add(item);
-    return 0;
+    return nullptr;
 }
 
-Item **JSONDict::getItems()
+void JSONDict::printItems(bool compact)
 {
-    return items.getAsArray();
+    print(compact);
 }
 
-Item *JSONDict::getItem(String *key)
+/**************************************
+**               LAZY                **
+**************************************/
+LazyJSON::LazyJSON(const char *chars, uint_fast64_t len, bool is_array,
+                   Arena *arena)
+    : chars(chars)
+    , len(len)
+    , is_array(is_array)
+    , parsed(false)
+    , json(nullptr)
+    , arena(arena)
+{}
+
+LazyJSON::~LazyJSON()
 {
-    uint_fast64_t size = getSize();
-    for (uint_fast64_t i = 0; i < size; ++i)
+    if (arena == nullptr)
     {
-        Item *it = items.get(i);
-        if (it != nullptr)
-        {
-            if (key == it->getKey())
-            {
-                return it;
-            }
-        }
+        delete json;
     }
-    return nullptr;
 }
 
-void JSONDict::printItems()
+bool LazyJSON::isArray()
 {
-#ifndef VALGRING_DISABLE_PRINT
-    printItemsIndent(1, false);
-#endif
+    return is_array;
 }
 
-void JSONDict::printItemsIndent(int indent, bool fromDict)
+/**
+** \returns The container, parsed the first time this is called
+*/
+JSON *LazyJSON::get()
 {
-    // Obtains the number of tab characters that will be printed
-    char *tabs = new char[indent]();
-    if (tabs == nullptr)
+    if (!parsed)
     {
-        return;
+        parsed = true;
+        json = parse_span(chars, len, arena);
     }
-    for (int i = 0; i < indent - 1; ++i)
+    return json;
+}
+
+/*******************************************************************************
+**                                  DOCUMENT                                  **
+*******************************************************************************/
+Document::Document(Arena *arena)
+    : arena(arena)
+    , root(nullptr)
+    , keys(nullptr)
+    , input(nullptr)
+    , input_size(0)
+    , input_mapped(false)
+{}
+
+Document::~Document()
+{
+    // The nodes allocated in the arena are freed with it
+    if (arena == nullptr)
     {
-        tabs[i] = '\t';
+        delete root;
     }
-    tabs[indent - 1] = '\0';
+    delete arena;
 
-    uint_fast64_t size = getSize();
-    if (size == 0)
+#ifndef DISABLE_MMAP
+    if (input_mapped)
     {
-        cout << (fromDict ? "" : tabs) << "{}";
-        if (indent == 1)
-        {
-            cout << endl;
-        }
-        delete[] tabs;
+        munmap((void *)input, input_size);
         return;
     }
+#endif
+    delete[] input;
+}
 
-    cout << (fromDict ? "" : tabs) << "{\n";
+Arena *Document::getArena()
+{
+    return arena;
+}
 
-    for (uint_fast64_t i = 0; i < size; ++i)
-    {
-        Item *it = items.get(i);
-        if (it == nullptr)
-        {
-            continue;
-        }
+JSON *Document::getRoot()
+{
+    return root;
+}
 
-        if (IS_ARR(it))
-        {
-            JSONArray *value = ((ArrayItem *)it)->getValue();
-            if (value != nullptr)
-            {
-                cout << "\t" << tabs;
-                it->printKey();
-                value->printValuesIndent(indent + 1, true);
-            }
-        }
-        else if (IS_DICT(it))
-        {
-            JSONDict *value = ((DictItem *)it)->getValue();
-            if (value != nullptr)
-            {
-                cout << "\t" << tabs;
-                it->printKey();
-                value->printItemsIndent(indent + 1, true);
-            }
-        }
-        else
-        {
-            cout << "\t" << tabs;
-            it->printNoFlush();
-        }
+void Document::setRoot(JSON *root)
+{
+    this->root = root;
+}
 
-        if (i < size - 1)
-        {
-            cout << ",\n";
-        }
-    }
+/**
+** \returns The table in which the keys of the dicts of the document are
+**          interned, nullptr if they are not (documents without arena). Its
+**          Strings can be given to JSONDict::getItem(String *), which then
+**          compares the keys by address
+*/
+KeyTable *Document::getKeys()
+{
+    return keys;
+}
 
-    cout << "\n" << tabs << "}";
+void Document::setKeys(KeyTable *keys)
+{
+    this->keys = keys;
+}
 
-    if (indent == 1)
-    {
-        cout << endl;
-    }
-    delete[] tabs;
+/**
+** \brief Gives the ownership of the input of the parser to the document, so
+**        that the strings of the json object can point into it
+** \param input The input, allocated with new[] or mapped with mmap()
+** \param size The size of the input
+** \param mapped Whether the input is mapped (it is then unmapped with the
+**               document instead of being deleted)
+*/
+void Document::retainInput(const char *input, uint_fast64_t size, bool mapped)
+{
+    this->input = input;
+    this->input_size = size;
+    this->input_mapped = mapped;
 }
@@ -4,25 +4,111 @@
 /*******************************************************************************
 **                                  INCLUDES                                  **
 *******************************************************************************/
+#include "arena.hpp"
+#include "array_list.hpp"
 #include "json_types.hpp"
-#include "linked_lists.hpp"
 
 /*******************************************************************************
 **                              DEFINES / MACROS                              **
 *******************************************************************************/
-#define IS_STRING(v) (dynamic_cast<Value *>(v) && (v)->getType() == T_STR)
-#define IS_INT(v) (dynamic_cast<Value *>(v) && (v)->getType() == T_INT)
-#define IS_DOUBLE(v) (dynamic_cast<Value *>(v) && (v)->getType() == T_DOUBLE)
-#define IS_BOOL(v) (dynamic_cast<Value *>(v) && (v)->getType() == T_BOOL)
-#define IS_NULL(v) (dynamic_cast<Value *>(v) && (v)->getType() == T_NULL)
-#define IS_ARR(v) (dynamic_cast<Value *>(v) && (v)->getType() == T_ARR)
-#define IS_DICT(v) (dynamic_cast<Value *>(v) && (v)->getType() == T_DICT)
-
-#define IS_JSON_ARRAY(j) (dynamic_cast<JSON *>(j) && (j)->isArray())
+#define IS_STRING(v) ((v) != nullptr && (v)->getType() == T_STR)
+#define IS_INT(v) ((v) != nullptr && (v)->getType() == T_INT)
+#define IS_DOUBLE(v) ((v) != nullptr && (v)->getType() == T_DOUBLE)
+#define IS_BOOL(v) ((v) != nullptr && (v)->getType() == T_BOOL)
+#define IS_NULL(v) ((v) != nullptr && (v)->getType() == T_NULL)
+#define IS_ARR(v) ((v) != nullptr && (v)->getType() == T_ARR)
+#define IS_DICT(v) ((v) != nullptr && (v)->getType() == T_DICT)
+
+#define IS_JSON_ARRAY(j) ((j) != nullptr && (j)->isArray())
+
+// Number of items from which a JSONDict builds a hash index of its keys,
+// smaller dicts are searched linearly
+#ifndef DICT_INDEX_MIN_SIZE
+#    define DICT_INDEX_MIN_SIZE 6
+#endif
 
 /*******************************************************************************
 **                                   CLASSES                                  **
 *******************************************************************************/
+class JSONArray;
+class JSONDict;
+class KeyTable;
+class LazyJSON;
+
+/**************************************
+**              VALUES               **
+**************************************/
+/**
+** \class Value Tagged cell holding a value of a JSONArray or a JSONDict
+** \brief The ints, doubles, bools and nulls are stored inside the cell, the
+**        strings, arrays and dicts are pointers owned by the container of the
+**        cell (they are freed by destroy()). Cells are plain data : they are
+**        copied by value and their type is dispatched with a switch
+** \param type The type of the value (T_<TYPE>)
+** \param lazy Whether the array or dict is a LazyJSON, which is parsed by
+**             getArray() or getDict()
+*/
+class Value
+{
+private:
+    unsigned char type;
+    bool lazy;
+    union
+    {
+        int_fast64_t i;
+        double d;
+        bool b;
+        String *s;
+        JSONArray *ja;
+        JSONDict *jd;
+        LazyJSON *lj;
+    };
+
+public:
+    Value();
+
+    static Value fromInt(int_fast64_t i);
+    static Value fromDouble(double d);
+    static Value fromBool(bool b);
+    static Value fromString(String *s);
+    static Value fromArray(JSONArray *ja);
+    static Value fromDict(JSONDict *jd);
+    static Value fromLazy(LazyJSON *lj);
+
+    unsigned char getType();
+    bool isLazy();
+    int_fast64_t getInt();
+    double getDouble();
+    bool getBool();
+    String *getString();
+    JSONArray *getArray();
+    JSONDict *getDict();
+
+    void destroy();
+    void print();
+};
+
+static_assert(sizeof(Value) <= 16, "A Value must fit in 16 bytes");
+
+/**
+** \class Item Entry of a JSONDict : a key and its value
+** \param key The key of the item, owned by the dict
+** \param value The value of the item
+*/
+class Item
+{
+private:
+    String *key;
+    Value value;
+
+public:
+    Item();
+    Item(String *key, Value value);
+
+    String *getKey();
+    Value *getValue();
+};
+
 /**************************************
 **               JSON                **
 **************************************/
@@ -32,243 +118,160 @@
 **        - JSONArray
 **        - JSONDict
 ** \param is_array Whether the JSON object is an array or a dict
+** \param arena The arena in which the object and its content are allocated,
+**              nullptr if they are allocated on the heap
 */
 class JSON
 {
 private:
     bool is_array;
+    Arena *arena;
 
 public:
-    JSON(bool is_array);
+    JSON(bool is_array, Arena *arena);
     virtual ~JSON() = default;
 
     bool isArray();
+    Arena *getArena();
+
+    void print(bool compact = false);
 };
 
 /**
 ** \class JSONArray
 ** \implements JSON
-** \param size The number of values inside the array
-** \param insert_idx The index where the next value will be added
-** \param values An array of TypedValues pointers (only contains objects of
-**               classes that are derived from the Value class)
+** \param values The values of the array
 */
 class JSONArray : public JSON
 {
 private:
-    LinkedList<Value> values;
+    ArrayList<Value> values;
 
 public:
-    JSONArray();
+    JSONArray(Arena *arena = nullptr);
     ~JSONArray();
 
     uint_fast64_t getSize();
-    Value **getValues();
+    void reserve(uint_fast64_t n);
+    Value *getValues();
     Value *getValueAt(uint_fast64_t index);
 
-    uint_fast16_t addValue(Value *value);
-    void printValues();
-    void printValuesIndent(int indent, bool fromDict);
+    uint_fast16_t addValue(Value value);
+    void printValues(bool compact = false);
 };
 
 /**
 ** \class JSONDict
 ** \implements JSON
-** \param items An array of Items pointers (only contains objects of
-**              classes that are derived from the Item class)
+** \param items The (key, value) pairs of the dict, in insertion order
+** \param index Open addressing hash table of the keys, each slot contains the
+**              position of an item in 'items' plus one (0 for an empty slot).
+**              It is nullptr while the dict has less than DICT_INDEX_MIN_SIZE
+**              items
+** \param index_capacity The number of slots of the index (power of 2)
+** \param keys The table in which the keys of the dict are interned, nullptr if
+**             they are not. The interned keys are compared by address (see
+**             KeyTable)
 */
 class JSONDict : public JSON
 {
 private:
-    LinkedList<Item> items;
+    ArrayList<Item> items;
+    uint_fast64_t *index;
+    uint_fast64_t index_capacity;
+    KeyTable *keys;
+
+    void buildIndex(uint_fast64_t n);
+    void indexItem(uint_fast64_t pos);
+    Item *findKey(String *key, uint_fast64_t hash);
 
 public:
-    JSONDict();
+    JSONDict(Arena *arena = nullptr, KeyTable *keys = nullptr);
     ~JSONDict();
 
     uint_fast64_t getSize();
-    Item **getItems();
+    void reserve(uint_fast64_t n);
+    Item *getItems();
     Item *getItem(String *key);
+    Item *getItem(const char *key, uint_strlen_t len);
+    Item *getItem(const char *key, uint_strlen_t len, uint_fast64_t hash);
 
-    uint_fast16_t addItem(Item *item);
-    void printItems();
-    void printItemsIndent(int indent, bool fromDict);
-};
-
-/**************************************
-**           TYPED VALUES            **
-**************************************/
-class StringValue : public Value
-{
-private:
-    String *value;
-
-public:
-    StringValue(String *value);
-    ~StringValue();
-
-    void printNoFlush();
-    String *getValue();
-};
-
-class IntValue : public Value
-{
-private:
-    int_fast64_t value;
-
-public:
-    IntValue(int_fast64_t value);
-
-    void printNoFlush();
-    int_fast64_t getValue();
-};
-
-class DoubleValue : public Value
-{
-private:
-    double value;
-
-public:
-    DoubleValue(double value);
-
-    void printNoFlush();
-    double getValue();
-};
-
-class BoolValue : public Value
-{
-private:
-    bool value;
-
-public:
-    BoolValue(bool value);
-
-    void printNoFlush();
-    bool getValue();
-};
-
-class NullValue : public Value
-{
-public:
-    NullValue();
-
-    void printNoFlush();
+    uint_fast16_t addItem(String *key, Value value);
+    uint_fast16_t addInternedItem(String *key, Value value);
+    void printItems(bool compact = false);
 };
 
-class ArrayValue : public Value
-{
-private:
-    JSONArray *ja;
-
-public:
-    ArrayValue(JSONArray *ja_arg);
-    virtual ~ArrayValue();
-
-    void printNoFlush();
-    void print();
-    JSONArray *getValue();
-};
-
-class DictValue : public Value
-{
-private:
-    JSONDict *jd;
-
-public:
-    DictValue(JSONDict *jd_arg);
-    virtual ~DictValue();
-
-    void printNoFlush();
-    void print();
-    JSONDict *getValue();
-};
-
-/**************************************
-**               ITEMS               **
-**************************************/
-class StringItem : public Item
-{
-private:
-    String *value;
-
-public:
-    StringItem(String *key, String *value);
-    ~StringItem();
-
-    void printNoFlush();
-    String *getValue();
-};
-
-class IntItem : public Item
-{
-private:
-    int64_t value;
-
-public:
-    IntItem(String *key, int64_t value);
-
-    void printNoFlush();
-    int64_t getValue();
-};
-
-class DoubleItem : public Item
-{
-private:
-    double value;
-
-public:
-    DoubleItem(String *key, double value);
-
-    void printNoFlush();
-    double getValue();
-};
-
-class BoolItem : public Item
-{
-private:
-    bool value;
-
-public:
-    BoolItem(String *key, bool value);
-
-    void printNoFlush();
-    bool getValue();
-};
-
-class NullItem : public Item
-{
-public:
-    NullItem(String *key);
-
-    void printNoFlush();
-};
-
-class ArrayItem : public Item
+/**
+** \class LazyJSON Array or dict of the input that is only parsed the first
+**                 time it is accessed
+** \brief Created by parse_lazy() for the nested containers : the parser only
+**        finds the end of the container (by matching its brackets) and keeps
+**        its characters, which point into the input retained by the document.
+**        When it is parsed, its own nested containers are also lazy
+** \param chars The characters of the container, from its '[' or '{' to the
+**              matching ']' or '}'
+** \param len The number of characters
+** \param is_array Whether the container is an array or a dict
+** \param parsed Whether the container was parsed
+** \param json The parsed container, nullptr before its first access (and if
+**             its content is invalid)
+** \param arena The arena in which the container is parsed, or nullptr
+*/
+class LazyJSON
 {
 private:
-    JSONArray *ja;
+    const char *chars;
+    uint_fast64_t len;
+    bool is_array;
+    bool parsed;
+    JSON *json;
+    Arena *arena;
 
 public:
-    ArrayItem(String *key, JSONArray *ja_arg);
-    virtual ~ArrayItem();
+    LazyJSON(const char *chars, uint_fast64_t len, bool is_array, Arena *arena);
+    ~LazyJSON();
 
-    void printNoFlush();
-    void print();
-    JSONArray *getValue();
+    bool isArray();
+    JSON *get();
 };
 
-class DictItem : public Item
+/**
+** \class Document Handle on a parsed json object
+** \brief If the document has an arena, all the nodes and strings of the json
+**        object are allocated in it and they are all freed at once with the
+**        document. Otherwise, the json object is deleted with the document
+**        The document can also keep the input of the parser alive, in which
+**        case the strings that don't contain escape sequences point directly
+**        into it instead of being copied
+** \param arena The arena of the document, or nullptr
+** \param root The json object
+** \param input The input that the strings of the json object point into,
+**              nullptr if they don't
+** \param input_size The size of the input
+** \param input_mapped Whether the input is mapped in memory or allocated
+** \param keys The table of the keys of the dicts, allocated in the arena
+**             (nullptr without arena)
+*/
+class Document
 {
 private:
-    JSONDict *jd;
+    Arena *arena;
+    JSON *root;
+    KeyTable *keys;
+    const char *input;
+    uint_fast64_t input_size;
+    bool input_mapped;
 
 public:
-    DictItem(String *key, JSONDict *jd_arg);
-    virtual ~DictItem();
-
-    void printNoFlush();
-    void print();
-    JSONDict *getValue();
+    Document(Arena *arena);
+    ~Document();
+
+    Arena *getArena();
+    JSON *getRoot();
+    void setRoot(JSON *root);
+    KeyTable *getKeys();
+    void setKeys(KeyTable *keys);
+    void retainInput(const char *input, uint_fast64_t size, bool mapped);
 };
 
 #endif // !JSON_HPP
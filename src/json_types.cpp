@@ -2,14 +2,18 @@
 
 #include <iostream>
 
-String::String(const char *str, uint_strlen_t len)
+String::String(const char *str, uint_strlen_t len, bool owned)
     : string(str)
     , length(len)
+    , owned(owned)
 {}
 
 String::~String()
 {
-    delete[] string;
+    if (owned)
+    {
+        delete[] string;
+    }
 }
 
 const char *String::str()
@@ -22,7 +26,7 @@ uint_strlen_t String::len()
     return length;
 }
 
-bool String::operator==(String s)
+bool String::operator==(String &s)
 {
     if (length != s.len())
     {
@@ -46,45 +50,26 @@ bool String::operator==(String s)
     return true;
 }
 
-Value::Value(unsigned char type)
-    : type(type)
-{}
-
-unsigned char Value::getType()
-{
-    return type;
-}
-
-void Value::print()
-{
-    printNoFlush();
-    std::cout.flush();
-}
-
-Item::Item(String *key, unsigned char type)
-    : Value(type)
-    , key(key)
-{}
-
-Item::~Item()
-{
-    delete key;
-}
-
-String *Item::getKey()
-{
-    return key;
-}
-
-void Item::printKey()
-{
-    std::cout << "\"" << (key == nullptr ? "" : key->str()) << "\""
-              << ": ";
-}
-
 /*******************************************************************************
 **                                 FUNCTIONS                                  **
 *******************************************************************************/
+/**
+** \brief Hashes the given bytes (64 bits FNV-1a)
+** \param str The bytes to hash
+** \param len The number of bytes
+** \returns The hash of the bytes
+*/
+uint_fast64_t hash_str(const char *str, uint_strlen_t len)
+{
+    uint_fast64_t h = 0xcbf29ce484222325ULL;
+    for (uint_strlen_t i = 0; i < len; ++i)
+    {
+        h ^= (unsigned char)str[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
 void print_err_bits(uint_fast16_t err)
 {
     std::cout << (ERR_FSEEK & err ? 1 : 0) << " : ERR_FSEEK\n"
@@ -99,5 +84,8 @@ void print_err_bits(uint_fast16_t err)
               << " : ERR_MAX_NESTED_DICTS_REACHED\n"
               << (ERR_NULL_VALUE & err ? 1 : 0) << " : ERR_NULL_VALUE\n"
               << (ERR_NULL_ITEM & err ? 1 : 0) << " : ERR_NULL_ITEM\n"
+              << (ERR_INVALID_JSON & err ? 1 : 0) << " : ERR_INVALID_JSON\n"
+              << (ERR_HANDLER_STOPPED & err ? 1 : 0)
+              << " : ERR_HANDLER_STOPPED\n"
               << std::endl;
 }
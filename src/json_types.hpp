@@ -27,6 +27,8 @@
 #define ERR_MAX_NESTED_DICTS_REACHED (1 << 7)
 #define ERR_NULL_VALUE (1 << 8)
 #define ERR_NULL_ITEM (1 << 9)
+#define ERR_INVALID_JSON (1 << 10)
+#define ERR_HANDLER_STOPPED (1 << 11)
 
 #ifndef MAX_STR_LEN
 #    define MAX_STR_LEN UINT_FAST16_MAX
@@ -43,79 +45,36 @@ typedef uint_fast64_t uint_strlen_t;
 /*******************************************************************************
 **                                   CLASSES                                  **
 *******************************************************************************/
+/**
+** \class String Characters of a json string or key
+** \brief The characters are not necessarily null terminated, as they can point
+**        directly into the input of the parser
+** \param string The characters
+** \param length The number of characters
+** \param owned Whether the characters were allocated with new[] for this
+**              string (and are freed with it)
+*/
 class String
 {
 private:
     const char *string;
     uint_strlen_t length;
+    bool owned;
 
 public:
-    String(const char *str, uint_strlen_t len);
+    String(const char *str, uint_strlen_t len, bool owned = true);
     ~String();
 
     const char *str();
     uint_strlen_t len();
 
-    bool operator==(String s);
-};
-
-/**
-** \class Value Base class representing a JSONArray's value
-** \brief The following classes are derived from this one :
-**        - StringValue
-**        - IntValue
-**        - DoubleValue
-**        - BoolValue
-**        - NulValue
-**        - ArrayValue
-**        - DictValue
-** \param type The type of the value (T_<TYPE>)
-*/
-class Value
-{
-private:
-    unsigned char type;
-
-public:
-    Value(unsigned char type);
-    virtual ~Value() = default;
-
-    unsigned char getType();
-
-    virtual void printNoFlush() = 0;
-    // Overriden by the Array and Dict class (TypedValue and Item)
-    virtual void print();
-};
-
-/**
-** \class Item Base class representing a JSONDict item
-** \brief The following classes are derived from this one :
-**        - StringItem
-**        - IntItem
-**        - DoubleItem
-**        - BoolItem
-**        - NullItem
-**        - ArrayItem
-**        - DictItem
-** \param key The key of the item (string)
-*/
-class Item : public Value
-{
-private:
-    String *key;
-
-public:
-    Item(String *key, unsigned char type);
-    virtual ~Item();
-
-    String *getKey();
-
-    void printKey();
+    bool operator==(String &s);
 };
 
 /*******************************************************************************
 **                                 FUNCTIONS                                  **
 *******************************************************************************/
+uint_fast64_t hash_str(const char *str, uint_strlen_t len);
 void print_err_bits(uint_fast16_t err);
 
 #endif // !JSON_TYPES_H
@@ -0,0 +1,130 @@
+#include "key_table.hpp"
+
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <cstring>
+
+/*******************************************************************************
+**                                 KEY TABLE                                  **
+*******************************************************************************/
+KeyTable::KeyTable(Arena *arena)
+    : arena(arena)
+    , slots(nullptr)
+    , capacity(0)
+    , size(0)
+{}
+
+/**
+** \brief Doubles the number of slots and inserts the keys in the new ones.
+**        The previous slots stay in the arena until it is freed
+*/
+void KeyTable::grow()
+{
+    uint_fast64_t new_capacity =
+        capacity == 0 ? BASE_KEY_TABLE_SIZE : capacity * 2;
+    Slot *tmp =
+        (Slot *)arena->alloc(new_capacity * sizeof(Slot), alignof(Slot));
+    std::memset((void *)tmp, 0, new_capacity * sizeof(Slot));
+
+    uint_fast64_t mask = new_capacity - 1;
+    for (uint_fast64_t i = 0; i < capacity; ++i)
+    {
+        if (slots[i].key == nullptr)
+        {
+            continue;
+        }
+
+        uint_fast64_t slot = slots[i].hash & mask;
+        while (tmp[slot].key != nullptr)
+        {
+            slot = (slot + 1) & mask;
+        }
+        tmp[slot] = slots[i];
+    }
+    slots = tmp;
+    capacity = new_capacity;
+}
+
+uint_fast64_t KeyTable::getSize()
+{
+    return size;
+}
+
+/**
+** \returns The slot of the given key, or the empty slot where it would be
+**          inserted (the table must have at least one empty slot)
+*/
+KeyTable::Slot *KeyTable::lookup(const char *str, uint_fast64_t len,
+                                 uint_fast64_t hash)
+{
+    uint_fast64_t mask = capacity - 1;
+    uint_fast64_t slot = hash & mask;
+    while (slots[slot].key != nullptr)
+    {
+        String *k = slots[slot].key;
+        if (slots[slot].hash == hash && k->len() == len
+            && std::memcmp(k->str(), str, len) == 0)
+        {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slots + slot;
+}
+
+/**
+** \returns The String of the given key, which is created the first time the
+**          key is interned. If 'in_input' is true, the characters are alive
+**          as long as the document and the String points into them, otherwise
+**          they are copied in the arena
+*/
+String *KeyTable::intern(const char *str, uint_fast64_t len, bool in_input)
+{
+    if ((size + 1) * 2 > capacity)
+    {
+        grow();
+    }
+
+    uint_fast64_t hash = hash_str(str, len);
+    Slot *slot = lookup(str, len, hash);
+    if (slot->key != nullptr)
+    {
+        return slot->key;
+    }
+
+    const char *chars = str;
+    if (!in_input)
+    {
+        char *copy = (char *)arena->alloc(len + 1, 1);
+        std::memcpy(copy, str, len);
+        copy[len] = 0;
+        chars = copy;
+    }
+    slot->hash = hash;
+    slot->key = arena_new<String>(arena, chars, len, false);
+    ++size;
+    return slot->key;
+}
+
+/**
+** \returns The interned String of the given key, nullptr if none of the dicts
+**          of the document has this key
+*/
+String *KeyTable::find(const char *str, uint_strlen_t len)
+{
+    return str == nullptr ? nullptr : find(str, len, hash_str(str, len));
+}
+
+/**
+** \brief Same as find(str, len), for a key whose hash was computed in advance
+**        (it must be hash_str(str, len))
+*/
+String *KeyTable::find(const char *str, uint_strlen_t len, uint_fast64_t hash)
+{
+    if (size == 0 || str == nullptr)
+    {
+        return nullptr;
+    }
+    return lookup(str, len, hash)->key;
+}
@@ -0,0 +1,62 @@
+#ifndef KEY_TABLE_HPP
+#define KEY_TABLE_HPP
+
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <stdint.h>
+
+#include "arena.hpp"
+#include "json_types.hpp"
+
+/*******************************************************************************
+**                              DEFINES / MACROS                              **
+*******************************************************************************/
+// Initial number of slots of a KeyTable, doubled when it is half full
+#define BASE_KEY_TABLE_SIZE 64
+
+/*******************************************************************************
+**                                   CLASSES                                  **
+*******************************************************************************/
+/**
+** \class KeyTable Symbol table of the keys of the dicts of a document
+** \brief Each distinct key is stored once, as a single String that all the
+**        dicts with this key share, so an array of records doesn't allocate
+**        the same keys for each record, and two interned keys are equal if and
+**        only if they are the same String.
+**        The table, its slots and its strings are allocated in the arena of
+**        the document, and are freed with it
+** \param arena The arena of the document
+** \param slots Open addressing hash table of the keys (linear probing), an
+**              empty slot has a nullptr key
+** \param capacity The number of slots (power of 2)
+** \param size The number of keys
+*/
+class KeyTable
+{
+private:
+    class Slot
+    {
+    public:
+        uint_fast64_t hash;
+        String *key;
+    };
+
+    Arena *arena;
+    Slot *slots;
+    uint_fast64_t capacity;
+    uint_fast64_t size;
+
+    void grow();
+    Slot *lookup(const char *str, uint_fast64_t len, uint_fast64_t hash);
+
+public:
+    KeyTable(Arena *arena);
+
+    uint_fast64_t getSize();
+    String *intern(const char *str, uint_fast64_t len, bool in_input);
+    String *find(const char *str, uint_strlen_t len);
+    String *find(const char *str, uint_strlen_t len, uint_fast64_t hash);
+};
+
+#endif // !KEY_TABLE_HPP
@@ -1,58 +1,154 @@
+#include <cstring>
+#include <iostream>
+
 #include "json.hpp"
+#include "ndjson.hpp"
 #include "parser.hpp"
+#include "snapshot.hpp"
 
 using namespace std;
 
-int main(int argc, char *argv[])
+/**
+** \brief Parses the lines of the given newline-delimited json file, and prints
+**        each record (the invalid ones are reported on the error output)
+** \returns Whether all the records are valid
+*/
+bool print_lines(char *file, bool compact)
 {
-    if (argc < 2)
+    NDJSONReader reader(file, true);
+    if (!reader.isValid())
     {
-        return 1;
+        return false;
     }
 
-    JSON *j = parse(argv[1]);
-    if (j == nullptr)
+    bool valid = true;
+    Document *doc = nullptr;
+    while (reader.next(&doc))
     {
-        return 1;
+        if (doc == nullptr)
+        {
+            cerr << "Invalid record at line " << reader.getLine() << endl;
+            valid = false;
+            continue;
+        }
+        doc->getRoot()->print(compact);
+        delete doc;
     }
+    return valid;
+}
+
+/**
+** \brief Prints how to use the program on the error output
+*/
+void print_usage()
+{
+    cerr << "Usage : json-parser-cpp [-c|--compact] [-l|--lines] "
+            "[-p|--parallel]\n"
+            "        [-s|--stats] [-t|--tape] [-C|--cache <snapshot>] <file>\n"
+            "The statistics (-s) are only collected by the default parsing, "
+            "not with -l, -p, -t or -C"
+         << endl;
+}
 
-    if (IS_JSON_ARRAY(j))
+/**
+** \brief Parses the given file and prints it, tab-indented by default or
+**        without any whitespace with the '-c' (or '--compact') option.
+**        With the '-l' (or '--lines') option, the file is read as
+**        newline-delimited json, and each record is printed. With the '-p' (or
+**        '--parallel') option, a large top-level array is parsed by one
+**        thread per core. With the '-s' (or '--stats') option, the statistics
+**        of the parsing are printed on the error output (see ParseStats), it
+**        can't be combined with the other ways of parsing the file.
+**        With the '-t' (or '--tape') option, the file is parsed in a Tape
+**        instead of a tree of JSONArray and JSONDict. With the '-C' (or
+**        '--cache') option followed by a file, the tape is loaded from this
+**        snapshot if it is up to date, and written to it otherwise (see
+**        parse_cached())
+**        Usage : json-parser-cpp [-c|--compact] [-l|--lines] [-p|--parallel]
+**                [-s|--stats] [-t|--tape] [-C|--cache <snapshot>] <file>
+*/
+int main(int argc, char *argv[])
+{
+    bool compact = false;
+    bool lines = false;
+    bool parallel = false;
+    bool stats = false;
+    bool tape = false;
+    char *snapshot = nullptr;
+    char *file = nullptr;
+    for (int i = 1; i < argc; ++i)
     {
-        JSONArray *ja = (JSONArray *)j;
-        ja->printValues();
+        if (strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--compact") == 0)
+        {
+            compact = true;
+        }
+        else if (strcmp(argv[i], "-l") == 0 || strcmp(argv[i], "--lines") == 0)
+        {
+            lines = true;
+        }
+        else if (strcmp(argv[i], "-p") == 0
+                 || strcmp(argv[i], "--parallel") == 0)
+        {
+            parallel = true;
+        }
+        else if (strcmp(argv[i], "-s") == 0 || strcmp(argv[i], "--stats") == 0)
+        {
+            stats = true;
+        }
+        else if (strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--tape") == 0)
+        {
+            tape = true;
+        }
+        else if ((strcmp(argv[i], "-C") == 0
+                  || strcmp(argv[i], "--cache") == 0)
+                 && i + 1 < argc)
+        {
+            snapshot = argv[++i];
+        }
+        else
+        {
+            file = argv[i];
+        }
     }
-    else
+    // Only parse() collects statistics
+    if (file == nullptr
+        || (stats && (lines || parallel || tape || snapshot != nullptr)))
     {
-        JSONDict *jd = (JSONDict *)j;
-        jd->printItems();
+        print_usage();
+        return 1;
     }
-    delete j;
-
-    /*LinkedList<TypedValue> *ll = new LinkedList<TypedValue>();
-    for (int i = 0; i < 100; ++i)
+    if (lines)
     {
-        ll->add(new IntTypedValue(i));
+        return print_lines(file, compact) ? 0 : 1;
     }
 
-    printf("size = %lu\n", ll->getSize());
-    printf("nb links = %lu\n", ll->getNbLinks());
-
-    ll->remove(5);
-    for (int i = 0; i < 16; ++i)
+    if (tape || snapshot != nullptr)
     {
-        ll->remove(1);
+        Tape *t = snapshot == nullptr ? parse_tape(file)
+                                      : parse_cached(file, snapshot);
+        if (t == nullptr)
+        {
+            return 1;
+        }
+        t->print(compact);
+        delete t;
+        return 0;
     }
-    printf("size = %lu\n", ll->getSize());
 
-    TypedValue *t = ll->get(1);
-    if (t != NULL)
+    ParseStats statistics;
+    ParseStats *collected = stats ? &statistics : nullptr;
+    Document *doc = parallel ? parse_parallel(file, true)
+                             : parse(file, true, collected);
+    if (doc == nullptr)
     {
-        t->print();
+        return 1;
     }
-    printf("\n%lu\n", ll->getNbLinks());
-    delete ll;*/
 
-    // cout << boolalpha;
-    // cout << (FastCompString("Testing", 7) == FastCompString("T", 1)) << endl;
+    doc->getRoot()->print(compact);
+    delete doc;
+    if (stats)
+    {
+        statistics.print(stderr);
+    }
     return 0;
 }
@@ -0,0 +1,330 @@
+#include "ndjson.hpp"
+
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <cstring>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "parser.hpp"
+
+/*******************************************************************************
+**                              DEFINES / MACROS                              **
+*******************************************************************************/
+// Initial size of the buffer in which the streams are read
+#define BASE_STREAM_BUFF_SIZE (1 << 16)
+
+/*******************************************************************************
+**                              LOCAL FUNCTIONS                               **
+*******************************************************************************/
+/**
+** \returns Whether the characters between 'start' and 'end' are all
+**          whitespaces
+*/
+static bool is_blank(const char *start, const char *end)
+{
+    for (; start < end; ++start)
+    {
+        if (*start != ' ' && *start != '\t' && *start != '\r')
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*******************************************************************************
+**                                NDJSON READER                               **
+*******************************************************************************/
+/**
+** \brief Reads the given file and starts the workers that parse it
+** \param use_arena Whether the documents of the records have an arena (see
+**                  parse(file, use_arena))
+** \param nb_workers The number of worker threads, 0 to use one per core
+*/
+NDJSONReader::NDJSONReader(char *file, bool use_arena,
+                           uint_fast32_t nb_workers)
+    : map(nullptr)
+    , buff(nullptr)
+    , data(nullptr)
+    , size(0)
+    , use_arena(use_arena)
+    , nb_chunks(0)
+    , next_chunk(0)
+    , cur_chunk(0)
+    , cur_record(0)
+    , base_line(0)
+    , line(0)
+    , stopping(false)
+    , workers(nullptr)
+    , nb_workers(0)
+{
+    for (uint_fast32_t i = 0; i < NDJSON_QUEUE_SIZE; ++i)
+    {
+        slots[i] = nullptr;
+    }
+    if (!readInput(file))
+    {
+        return;
+    }
+
+    nb_chunks = (size + NDJSON_CHUNK_SIZE - 1) / NDJSON_CHUNK_SIZE;
+    if (nb_workers == 0)
+    {
+        nb_workers = std::thread::hardware_concurrency();
+    }
+    // No more workers than chunks that can be parsed ahead
+    if (nb_workers == 0 || nb_workers > NDJSON_QUEUE_SIZE)
+    {
+        nb_workers = nb_workers == 0 ? 1 : NDJSON_QUEUE_SIZE;
+    }
+
+    this->nb_workers = nb_workers;
+    workers = new std::thread[nb_workers];
+    for (uint_fast32_t i = 0; i < nb_workers; ++i)
+    {
+        workers[i] = std::thread(&NDJSONReader::work, this);
+    }
+}
+
+/**
+** \brief Stops the workers, and frees the records that were not read
+*/
+NDJSONReader::~NDJSONReader()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    freed.notify_all();
+    for (uint_fast32_t i = 0; i < nb_workers; ++i)
+    {
+        workers[i].join();
+    }
+    delete[] workers;
+
+    for (uint_fast32_t i = 0; i < NDJSON_QUEUE_SIZE; ++i)
+    {
+        if (slots[i] == nullptr)
+        {
+            continue;
+        }
+        // The records of the current chunk before 'cur_record' were given
+        uint_fast64_t first =
+            i == cur_chunk % NDJSON_QUEUE_SIZE ? cur_record : 0;
+        for (uint_fast64_t r = first; r < slots[i]->records.getSize(); ++r)
+        {
+            delete slots[i]->records.get(r)->doc;
+        }
+        delete slots[i];
+    }
+
+    if (map != nullptr)
+    {
+        munmap(map, size);
+    }
+    delete[] buff;
+}
+
+/**
+** \brief Maps the given file in memory if it is a regular file, reads it
+**        entirely in a buffer otherwise
+** \returns false if the file could not be read
+*/
+bool NDJSONReader::readInput(char *file)
+{
+    int fd = file == nullptr ? -1 : open(file, O_RDONLY);
+    if (fd == -1)
+    {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+#ifndef DISABLE_MMAP
+    // Empty files can't be mapped
+    if (S_ISREG(st.st_mode) && st.st_size > 0)
+    {
+        void *m = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (m != MAP_FAILED)
+        {
+            // Only a hint to the kernel, so the error is ignored
+            madvise(m, st.st_size, MADV_SEQUENTIAL);
+            close(fd);
+            map = m;
+            data = (const char *)m;
+            size = st.st_size;
+            return true;
+        }
+    }
+#endif
+
+    FILE *f = fdopen(fd, "r");
+    if (f == nullptr)
+    {
+        close(fd);
+        return false;
+    }
+
+    uint_fast64_t capacity = S_ISREG(st.st_mode) && st.st_size > 0
+        ? st.st_size
+        : BASE_STREAM_BUFF_SIZE;
+    buff = new char[capacity];
+    while (1)
+    {
+        size += fread(buff + size, sizeof(char), capacity - size, f);
+        if (size < capacity)
+        {
+            break;
+        }
+        char *tmp = new char[capacity * 2];
+        std::memcpy(tmp, buff, size);
+        delete[] buff;
+        buff = tmp;
+        capacity *= 2;
+    }
+    fclose(f);
+    data = buff;
+    return true;
+}
+
+/**
+** \returns The position of the first line of the given chunk, which is the
+**          first line that starts in its NDJSON_CHUNK_SIZE characters (the
+**          size of the input if there is none)
+*/
+uint_fast64_t NDJSONReader::chunkStart(uint_fast64_t chunk)
+{
+    if (chunk == 0)
+    {
+        return 0;
+    }
+
+    // A line starts at the chunk if the previous character ends a line
+    uint_fast64_t pos = chunk * NDJSON_CHUNK_SIZE - 1;
+    if (pos >= size)
+    {
+        return size;
+    }
+    const char *nl = (const char *)std::memchr(data + pos, '\n', size - pos);
+    return nl == nullptr ? size : nl - data + 1;
+}
+
+/**
+** \brief Parses the lines of the given chunk
+*/
+NDJSONReader::Batch *NDJSONReader::parseChunk(uint_fast64_t chunk)
+{
+    Batch *batch = new Batch();
+    const char *c = data + chunkStart(chunk);
+    const char *end = data + chunkStart(chunk + 1);
+    while (c < end)
+    {
+        const char *nl = (const char *)std::memchr(c, '\n', end - c);
+        const char *eol = nl == nullptr ? end : nl;
+        if (!is_blank(c, eol))
+        {
+            Record record;
+            record.doc = parse_buffer(c, eol - c, use_arena);
+            record.line = batch->nb_lines;
+            batch->records.add(record);
+        }
+        ++batch->nb_lines;
+        c = eol + 1;
+    }
+    return batch;
+}
+
+/**
+** \brief Loop of the workers : takes the next chunk to parse, as long as its
+**        slot in the queue is free, and puts its records in the slot
+*/
+void NDJSONReader::work()
+{
+    while (1)
+    {
+        uint_fast64_t chunk = 0;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            freed.wait(lock, [this] {
+                return stopping || next_chunk >= nb_chunks
+                    || next_chunk < cur_chunk + NDJSON_QUEUE_SIZE;
+            });
+            if (stopping || next_chunk >= nb_chunks)
+            {
+                return;
+            }
+            chunk = next_chunk++;
+        }
+
+        Batch *batch = parseChunk(chunk);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            slots[chunk % NDJSON_QUEUE_SIZE] = batch;
+        }
+        parsed.notify_all();
+    }
+}
+
+bool NDJSONReader::isValid()
+{
+    return data != nullptr;
+}
+
+/**
+** \brief Gives the document of the next record, in the order of the input.
+**        The caller owns the document and has to delete it
+** \param doc Set to the document of the record, nullptr if its line is not a
+**            valid json array or dict (see getLine())
+** \returns false if there are no more records
+*/
+bool NDJSONReader::next(Document **doc)
+{
+    while (cur_chunk < nb_chunks)
+    {
+        uint_fast32_t slot = cur_chunk % NDJSON_QUEUE_SIZE;
+        Batch *batch = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            parsed.wait(lock, [this, slot] { return slots[slot] != nullptr; });
+            batch = slots[slot];
+        }
+
+        if (cur_record < batch->records.getSize())
+        {
+            Record *record = batch->records.get(cur_record++);
+            *doc = record->doc;
+            line = base_line + record->line + 1;
+            return true;
+        }
+
+        // All the records of the chunk were read, its slot is given back
+        base_line += batch->nb_lines;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            slots[slot] = nullptr;
+            ++cur_chunk;
+            cur_record = 0;
+        }
+        freed.notify_all();
+        delete batch;
+    }
+    return false;
+}
+
+/**
+** \returns The line number (starting at 1) of the last record given by next()
+*/
+uint_fast64_t NDJSONReader::getLine()
+{
+    return line;
+}
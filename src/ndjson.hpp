@@ -0,0 +1,124 @@
+#ifndef NDJSON_HPP
+#define NDJSON_HPP
+
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <condition_variable>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+
+#include "array_list.hpp"
+#include "json.hpp"
+
+/*******************************************************************************
+**                              DEFINES / MACROS                              **
+*******************************************************************************/
+/**
+** \def Number of characters of the input given to a worker at once (the lines
+**      that start in these characters)
+*/
+#ifndef NDJSON_CHUNK_SIZE
+#    define NDJSON_CHUNK_SIZE (1 << 18) // 256 KiB
+#endif
+
+/**
+** \def Maximum number of chunks that are parsed ahead of the one being read,
+**      which bounds the memory used by the records that wait to be read
+*/
+#ifndef NDJSON_QUEUE_SIZE
+#    define NDJSON_QUEUE_SIZE 16
+#endif
+
+/*******************************************************************************
+**                                   CLASSES                                  **
+*******************************************************************************/
+/**
+** \class NDJSONReader Reader of newline-delimited json (JSON Lines), one json
+**                     array or dict per line
+** \brief The input is cut into chunks of NDJSON_CHUNK_SIZE characters (at line
+**        boundaries), which are parsed by a pool of worker threads with
+**        parse_buffer(chars, len, use_arena). next() gives the records in the
+**        order of the input : the chunks that are parsed are kept in a queue
+**        of NDJSON_QUEUE_SIZE slots, and the workers wait for a free slot when
+**        they are too far ahead of the reader.
+**        The blank lines are skipped. Regular files are mapped in memory, the
+**        other streams are read entirely first
+** \param map The mapping of the file, nullptr if it is not mapped
+** \param buff The buffer in which the input is read if it is not mapped
+** \param data The characters of the input
+** \param size The number of characters of the input
+** \param use_arena Whether the documents of the records have an arena
+** \param nb_chunks The number of chunks of the input
+** \param next_chunk The next chunk that a worker will parse
+** \param cur_chunk The chunk whose records are being read by next()
+** \param cur_record The next record of the current chunk
+** \param base_line The number of lines before the current chunk
+** \param line The line number of the last record given by next()
+** \param slots The parsed chunks, chunk k being in slot k % NDJSON_QUEUE_SIZE
+**              (nullptr if it is not parsed yet)
+** \param stopping Set when the reader is destroyed, to stop the workers
+*/
+class NDJSONReader
+{
+private:
+    /**
+    ** \class Record Document of a line, nullptr if the line is not a valid
+    **               json array or dict
+    ** \param line The position of the line in its chunk
+    */
+    class Record
+    {
+    public:
+        Document *doc;
+        uint_fast64_t line;
+    };
+
+    /**
+    ** \class Batch Records of a chunk
+    ** \param nb_lines The number of lines of the chunk (blank ones included)
+    */
+    class Batch
+    {
+    public:
+        ArrayList<Record> records;
+        uint_fast64_t nb_lines = 0;
+    };
+
+    void *map;
+    char *buff;
+    const char *data;
+    uint_fast64_t size;
+    bool use_arena;
+
+    uint_fast64_t nb_chunks;
+    uint_fast64_t next_chunk;
+    uint_fast64_t cur_chunk;
+    uint_fast64_t cur_record;
+    uint_fast64_t base_line;
+    uint_fast64_t line;
+    Batch *slots[NDJSON_QUEUE_SIZE];
+    bool stopping;
+
+    std::thread *workers;
+    uint_fast32_t nb_workers;
+    std::mutex mutex;
+    std::condition_variable parsed;
+    std::condition_variable freed;
+
+    bool readInput(char *file);
+    uint_fast64_t chunkStart(uint_fast64_t chunk);
+    Batch *parseChunk(uint_fast64_t chunk);
+    void work();
+
+public:
+    NDJSONReader(char *file, bool use_arena, uint_fast32_t nb_workers = 0);
+    ~NDJSONReader();
+
+    bool isValid();
+    bool next(Document **doc);
+    uint_fast64_t getLine();
+};
+
+#endif // !NDJSON_HPP
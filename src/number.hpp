@@ -0,0 +1,70 @@
+#ifndef NUMBER_HPP
+#define NUMBER_HPP
+
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <stdint.h>
+
+/*******************************************************************************
+**                              DEFINES / MACROS                              **
+*******************************************************************************/
+// Number of characters that are enough for any number written by write_int()
+// or write_double()
+#define NUMBER_BUFF_SIZE 32
+
+/*******************************************************************************
+**                                   CLASSES                                  **
+*******************************************************************************/
+/**
+** \class Number Result of read_number()
+** \param is_float Whether the number is a double ('d') or an integer ('i')
+** \param i The value of the number if it is an integer
+** \param d The value of the number if it is a double
+*/
+class Number
+{
+public:
+    bool is_float;
+    int_fast64_t i;
+    double d;
+};
+
+/*******************************************************************************
+**                                 FUNCTIONS                                  **
+*******************************************************************************/
+/**
+** \brief Parses the json number at the beginning of the 'len' characters at
+**        'str', in place and in a single pass.
+**        The numbers without fraction nor exponent are integers, unless they
+**        overflow an int64_t, in which case they are read as doubles like the
+**        other numbers. The doubles are correctly rounded (Clinger's fast path,
+**        then the Eisel-Lemire algorithm, then strtod() for the few numbers
+**        that these can't decide)
+** \param str The characters, not necessarily null terminated
+** \param len The number of characters available at 'str'
+** \param n The parsed number
+** \returns The number of characters of the number, 0 if 'str' does not start
+**          with a valid number
+*/
+uint_fast64_t read_number(const char *str, uint_fast64_t len, Number *n);
+
+/**
+** \brief Writes the decimal representation of the integer 'i' at 'buff'
+** \param buff A buffer of at least NUMBER_BUFF_SIZE characters
+** \returns The number of characters written (not null terminated)
+*/
+uint_fast8_t write_int(int_fast64_t i, char *buff);
+
+/**
+** \brief Writes the shortest representation of the finite double 'd' that is
+**        read back as 'd' at 'buff'. It is written in scientific notation
+**        (1.5e+20) if its exponent is lower than -4 or greater than 15, in
+**        fixed notation otherwise (0.001, 150.0, 1.5). It always contains a
+**        '.' or an exponent, so that it is read back as a double
+** \param buff A buffer of at least NUMBER_BUFF_SIZE characters
+** \returns The number of characters written (not null terminated)
+*/
+uint_fast8_t write_double(double d, char *buff);
+
+#endif // !NUMBER_HPP
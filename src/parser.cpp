@@ -3,33 +3,50 @@
 /*******************************************************************************
 **                                  INCLUDES                                  **
 *******************************************************************************/
-#include <cmath>
+#include <condition_variable>
 #include <cstring>
+#include <fcntl.h>
+#include <mutex>
 #include <stdio.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
 
+#include "handler.hpp"
 #include "json.hpp"
+#include "key_table.hpp"
+#include "number.hpp"
+#include "reader.hpp"
+#include "scanner.hpp"
+#include "stats.hpp"
+#include "tape.hpp"
 
 /*******************************************************************************
 **                                   MACROS                                   **
 *******************************************************************************/
-#define IS_NUMBER_START(c) (('0' <= (c) && (c) <= '9') || (c) == '-')
-#define IS_BOOL_START(c) ((c) == 't' || (c) == 'f')
-
-#define IS_END_CHAR(c)                                                         \
-    ((c) == 0 || (c) == ',' || (c) == '\n' || (c) == ']' || (c) == '}')
-
-#define IS_STRING_END(c) ((c) == 0 || ((c) == '"' && prev_c != '\\'))
+/**
+** \def Number of frames and values initially allocated for the stacks of
+**      the DOMBuilder, they are doubled each time they are full
+*/
+#define BASE_STACK_SIZE 16
 
-#define IS_NOT_BOOLEAN(c, l)                                                   \
-    ((l) == 0 || ((c) == 'f' && (l) != 5) || ((c) == 't' && (l) != 4))
+/**
+** \def Size of the blocks of the arena of a document parsed from a buffer of
+**      'len' characters : the nodes and strings of a small document take a
+**      few times the size of its input, so it doesn't need a whole block of
+**      ARENA_BLOCK_SIZE bytes
+*/
+#define BUFF_ARENA_BLOCK_SIZE(len)                                             \
+    ((len) < ARENA_BLOCK_SIZE / 4 ? (len) * 4 + 256 : ARENA_BLOCK_SIZE)
 
 /**
-** \def Used by the functions that read the file using fseef() and fgetc()
-**      inside while loops, it sets the cursor on the 'p' position,
-**      increments 'p' and puts in 'c' the current character
+** \def Minimum number of characters of the parts of an array that are parsed
+**      in parallel (each part ends at the first top-level comma after them)
 */
-#define SEEK_AND_GET_CHAR(p) (!fseek(f, p++, SEEK_SET) && (c = fgetc(f)) != EOF)
+#ifndef PARALLEL_CHUNK_SIZE
+#    define PARALLEL_CHUNK_SIZE (1 << 16) // 64 KiB
+#endif
 
 #ifndef MAX_READ_BUFF_SIZE
 #    define MAX_READ_BUFF_SIZE (1 << 30) // ~= ~ 1 GB
@@ -43,6 +60,35 @@
 #    define MAX_NESTED_DICTS UINT_FAST8_MAX // 255
 #endif
 
+/**
+** \def Whether the strings point into their input buffer instead of being
+**      copied, when something keeps the buffer alive
+*/
+#ifdef DISABLE_STRING_VIEWS
+#    define USE_STRING_VIEWS false
+#else
+#    define USE_STRING_VIEWS true
+#endif
+
+/**
+** \def Whether the strings of the documents point into their input buffer
+**      instead of being copied (only possible when there is a document to keep
+**      the buffer alive)
+*/
+#define RETAIN_INPUT(doc) (USE_STRING_VIEWS && (doc) != nullptr)
+
+/**
+** \def New KeyTable in which the keys of the dicts of a document are interned,
+**      allocated in its arena (the documents without arena free the keys of
+**      each dict with it, so they can't share them)
+*/
+#ifdef DISABLE_KEY_INTERNING
+#    define NEW_KEY_TABLE(arena) ((KeyTable *)nullptr)
+#else
+#    define NEW_KEY_TABLE(arena)                                               \
+        ((arena) == nullptr ? nullptr : arena_new<KeyTable>((arena), (arena)))
+#endif
+
 #if MAX_NESTED_ARRAYS <= UINT_FAST8_MAX
 typedef uint_fast8_t uint_nested_arrays_t;
 #elif MAX_NESTED_ARRAYS <= UINT_FAST16_MAX
@@ -67,198 +113,163 @@ typedef uint_fast64_t uint_nested_dicts_t;
 **                                 STRUCTURES                                 **
 *******************************************************************************/
 /**
-** \class StrAndLenTuple
-** \brief Used by the parse_number() function to return multiple informations
+** \class Frame
+** \brief An entry of the container stack used by the DOMBuilder
+** \param json The container (array or dict) currently being filled
+** \param key If the container is a dict, the key that is waiting for its value
+** \param start The index in the values of the stack of the first value of the
+**              container
+** \param is_array Whether the container is an array or a dict
 */
-class StrAndLenTuple
+class Frame
 {
 public:
-    char *str;
-    uint_strlen_t len;
-    bool is_float;
-    bool has_exponent;
-
-    StrAndLenTuple(char *str, uint_strlen_t len, bool is_float,
-                   bool has_exponent)
-        : str(str)
-        , len(len)
-        , is_float(is_float)
-        , has_exponent(has_exponent)
+    JSON *json;
+    String *key;
+    uint_fast64_t start;
+    bool is_array;
+
+    Frame()
+        : json(nullptr)
+        , key(nullptr)
+        , start(0)
+        , is_array(false)
     {}
-
-    StrAndLenTuple()
-        : str(nullptr)
-        , len(0)
-        , is_float(false)
-        , has_exponent(false)
-    {}
-
-    ~StrAndLenTuple()
-    {
-        delete[] str;
-        str = nullptr;
-    }
 };
 
-/*******************************************************************************
-**                           FUNCTIONS DECLARATIONS                           **
-*******************************************************************************/
-JSONDict *parse_dict_buff(char *b, uint_fast64_t *pos, uint_fast16_t *err);
-JSONDict *parse_dict(FILE *f, uint_fast64_t *pos, uint_fast16_t *err);
-
-/*******************************************************************************
-**                              LOCAL FUNCTIONS                               **
-*******************************************************************************/
 /**
-** \brief Takes sl's char array and transforms it into an int64_t.
-**        If the number has an exponent, the exponent is parsed as well and the
-**        number is elevated to that exponent
-** \param sl A pointer to an StrAndLenTuple object
-** \returns The 0 in case of error (or if the number was 0), the number
-**          otherwise
+** \class ParseStack
+** \brief The stacks used by the DOMBuilder : the frames of the containers
+**        that are being parsed, and the values that were parsed for them.
+**        The values of a container are only moved into it once it is closed,
+**        when their number is known, so that its storage is allocated with the
+**        exact size
+** \param arena The arena in which the nodes are allocated, or nullptr
+** \param frames The frames, the last one being the innermost container
+** \param values The values of the containers, the ones of a frame starting
+**              at its 'start' index. They are stored as items whose key is the
+**              pending key of the frame when the value was parsed (nullptr for
+**              arrays)
 */
-int_fast64_t str_to_long(StrAndLenTuple *sl)
+class ParseStack
 {
-    if (sl == nullptr)
+private:
+    Arena *arena;
+    uint_fast64_t frames_size;
+    uint_fast64_t values_size;
+
+public:
+    Frame *frames;
+    uint_fast64_t nb_frames;
+    Item *values;
+    uint_fast64_t nb_values;
+
+    ParseStack(Arena *arena)
+        : arena(arena)
+        , frames_size(BASE_STACK_SIZE)
+        , values_size(BASE_STACK_SIZE)
+        , frames(new Frame[BASE_STACK_SIZE])
+        , nb_frames(0)
+        , values(new Item[BASE_STACK_SIZE])
+        , nb_values(0)
     {
-        return 0;
+        STATS_ALLOC(BASE_STACK_SIZE * (sizeof(Frame) + sizeof(Item)));
     }
 
-    char *str = sl->str;
-    uint_fast64_t len = sl->len;
-    if (str == nullptr || len == 0)
+    ~ParseStack()
     {
-        return 0;
+        delete[] frames;
+        delete[] values;
     }
 
-    int_fast64_t res = 0;
-    uint_fast64_t exponent = 0;
-    char is_negative = str[0] == '-' ? -1 : 1;
-    char is_in_exponent = 0;
-    char c = 0;
-    for (uint_fast64_t i = 0; i < len; ++i)
+    /**
+    ** \returns The new top frame, whose values start after the current ones
+    */
+    Frame *pushFrame()
     {
-        c = str[i];
-        if (sl->has_exponent && (c == 'e' || c == 'E'))
-        {
-            is_in_exponent = 1;
-        }
-        else if ('0' <= c && c <= '9')
+        if (nb_frames == frames_size)
         {
-            if (is_in_exponent)
-            {
-                exponent = exponent * 10 + c - '0';
-            }
-            else
-            {
-                res = res * 10 + c - '0';
-            }
+            STATS_ALLOC(frames_size * 2 * sizeof(Frame));
+            Frame *tmp = new Frame[frames_size * 2];
+            std::memcpy(tmp, frames, frames_size * sizeof(Frame));
+            delete[] frames;
+            frames = tmp;
+            frames_size *= 2;
         }
+        Frame *f = frames + nb_frames++;
+        *f = Frame();
+        f->start = nb_values;
+        return f;
     }
-    return sl->has_exponent ? pow(res * is_negative, exponent)
-                            : res * is_negative;
-}
 
-/**
-** \brief Takes sl's char array and transforms it into a double.
-**        If the number has an exponent, the exponent is parsed as well and the
-**        number is elevated to that exponent
-** \param sl A pointer to an StrAndLenTuple object
-** \returns The 0 in case of error (or if the number was 0), the number
-**          otherwise
-*/
-// FIX: Precision error
-double str_to_double(StrAndLenTuple *sl)
-{
-    if (sl == nullptr)
+    /**
+    ** \returns The new top frame
+    */
+    Frame *popFrame()
     {
-        return 0;
+        return frames + --nb_frames - 1;
     }
 
-    char *str = sl->str;
-    uint_fast64_t len = sl->len;
-    if (str == nullptr || len == 0)
+    void pushValue(Item value)
     {
-        return 0;
+        if (nb_values == values_size)
+        {
+            STATS_ALLOC(values_size * 2 * sizeof(Item));
+            Item *tmp = new Item[values_size * 2];
+            std::memcpy((void *)tmp, (void *)values,
+                        values_size * sizeof(Item));
+            delete[] values;
+            values = tmp;
+            values_size *= 2;
+        }
+        values[nb_values++] = value;
     }
 
-    double res = 0; // Integer part
-    double dot_res = 0; // Decimal part
-    uint_fast64_t exponent = 0; // Only used if sl->has_exponent() is true
-    uint_fast64_t nb_digits_dot = 1;
-    // If the number is negative, this is set to -1 and the final res is
-    // multiplied by it
-    char is_negative = str[0] == '-' ? -1 : 1;
-    char dot_reached = 0;
-    char is_in_exponent = 0;
-    char c = 0;
-    for (uint_fast64_t i = 0; i < len; ++i)
+    /**
+    ** \brief Frees the containers, the pending keys and the values that are
+    **        still on the stack (used when an error occurs). If they are
+    **        allocated in an arena, they are freed with it
+    */
+    void freeContent()
     {
-        c = str[i];
-        if (c == '.')
-        {
-            dot_reached = 1;
-        }
-        else if (sl->has_exponent && (c == 'e' || c == 'E'))
+        if (arena != nullptr)
         {
-            is_in_exponent = 1;
+            return;
         }
-        else if ('0' <= c && c <= '9')
+
+        // The values and the containers of the frames are not yet inside their
+        // parent
+        for (uint_fast64_t i = 0; i < nb_values; ++i)
         {
-            if (is_in_exponent)
-            {
-                exponent = exponent * 10 + c - '0';
-            }
-            else if (dot_reached)
-            {
-                dot_res = dot_res * 10 + c - '0';
-                nb_digits_dot *= 10;
-            }
-            else
-            {
-                res = res * 10 + c - '0';
-            }
+            delete values[i].getKey();
+            values[i].getValue()->destroy();
         }
-    }
-    return sl->has_exponent
-        ? pow(is_negative * (res + (dot_res / nb_digits_dot)), exponent)
-        : is_negative * (res + (dot_res / nb_digits_dot));
-}
-
-bool is_float(char *str, uint_fast64_t len)
-{
-    if (str == nullptr)
-    {
-        return false;
-    }
-
-    for (uint_fast64_t i = 0; i < len; ++i)
-    {
-        if (str[i] == '.')
+        for (uint_fast64_t f = 0; f < nb_frames; ++f)
         {
-            return true;
+            delete frames[f].json;
+            delete frames[f].key;
         }
+        nb_values = 0;
+        nb_frames = 0;
     }
-    return false;
-}
+};
 
-bool has_exponent(char *str, uint_fast64_t len)
+/**
+** \class ParseBuffers
+** \brief The buffers used by parse_container() : the containers that are
+**        open, and the buffer in which the escaped strings are decoded. A
+**        Parser keeps them from one parsing to the next
+*/
+class ParseBuffers
 {
-    if (str == nullptr)
-    {
-        return false;
-    }
-
-    for (uint_fast64_t i = 0; i < len; ++i)
-    {
-        if (str[i] == 'e' || str[i] == 'E')
-        {
-            return true;
-        }
-    }
-    return false;
-}
+public:
+    ArrayList<Level> levels;
+    Scratch scratch;
+};
 
+/*******************************************************************************
+**                              LOCAL FUNCTIONS                               **
+*******************************************************************************/
 bool max_nested_arrays_reached(uint_nested_arrays_t is_in_array,
                                uint_fast16_t *err)
 {
@@ -300,1311 +311,1325 @@ bool max_nested_dicts_reached(uint_nested_dicts_t is_in_dict,
 }
 
 /**
-** \brief Parses the string starting at 'pos + 1' (first char after the '"')
-** \param buff The buffer containing the current json file or object
-** \param idx A pointer to the uint_fast64_t containing the index of the '"'
-**            that started the string we want to parse
-** \returns An empty string in case of error, the parsed string otherwise
+** \brief Adds the given value to the values of the given frame (which is the
+**        top frame of the stack). If the frame is a dict, the value is paired
+**        with the pending key of the frame, which it now owns
 */
-String *parse_string_buff(char *buff, uint_fast64_t *idx)
+void add_value(ParseStack *st, Frame *frame, Value value)
 {
-    if (buff == nullptr || idx == nullptr)
-    {
-        return nullptr;
-    }
-
-    uint_fast64_t start_idx = *idx + 1;
-    uint_fast64_t len = 0;
-    char c = 0;
-    char prev_c = 0;
-    // Counts the number of characters until the first one that is an 'end char'
-    while (1)
-    {
-        c = buff[start_idx + len];
-        if (IS_STRING_END(c))
-        {
-            break;
-        }
-        prev_c = c;
-        ++len;
-    }
-
-    if (len == 0)
-    {
-        return nullptr;
-    }
-
-    char *str = new char[len + 1]();
-    if (str == nullptr)
-    {
-        return nullptr;
-    }
-    std::memcpy(str, buff + start_idx, len);
-
-    // + 1 to not read the last '"' when returning in the calling function
-    *idx += len + 1;
-    return new String(str, len);
+    st->pushValue(Item(frame->key, value));
+    frame->key = nullptr;
 }
 
 /**
-** \brief Reads the buffer from the given pos - 1
-** \param buff The buffer containing the current json file or object
-** \param idx The index of the second character of the number (the first one
-**            was already read)
-** \returns An instance of the StrAndLenTuple class containing the number as a
-**          char array, the length of the char array and whether the number is a
-**          float and has an exponent
+** \brief Moves the values of the given frame (which is the top frame of the
+**        stack) into its container, whose storage is allocated with the exact
+**        number of values
+** \returns The error bits set by JSONArray::addValue() or
+**          JSONDict::addInternedItem(), except ERR_ITEM_EXISTS as a
+**          duplicated key only means that the item is not added
 */
-StrAndLenTuple parse_number_buff(char *buff, uint_fast64_t *idx)
+uint_fast16_t close_frame(ParseStack *st, Frame *frame)
 {
-    if (buff == nullptr || idx == nullptr)
-    {
-        return StrAndLenTuple();
-    }
-
-    // Counts the number of characters until the first one that is an 'end char'
-    uint_fast64_t end_idx = *idx;
-    uint_fast64_t initial_i = end_idx;
-    char c = 0;
-    while (1)
+    uint_fast16_t err = 0;
+    uint_fast64_t nb_values = st->nb_values - frame->start;
+    Item *values = st->values + frame->start;
+    if (frame->is_array)
     {
-        c = buff[end_idx];
-        if (IS_END_CHAR(c))
+        JSONArray *ja = (JSONArray *)frame->json;
+        ja->reserve(nb_values);
+        for (uint_fast64_t i = 0; i < nb_values; ++i)
         {
-            break;
+            err |= ja->addValue(*values[i].getValue());
         }
-        ++end_idx;
-    }
-
-    // Number of chars
-    uint_fast64_t len = end_idx - initial_i;
-    if (len == 0)
-    {
-        return StrAndLenTuple();
-    }
-
-    // Puts the value in the form of a char array
-    char *str = new char[len + 1]();
-    if (str == nullptr)
-    {
-        return StrAndLenTuple();
-    }
-    std::memcpy(str, buff + initial_i, len);
-
-    *idx += len - 1;
-    return StrAndLenTuple(str, len, is_float(str, len), has_exponent(str, len));
-}
-
-/**
-** \returns 5 if false, 4 if true, 0 otherwise
-**/
-uint_fast64_t parse_boolean_buff(char *buff, uint_fast64_t *idx)
-{
-    if (buff == nullptr || idx == nullptr)
-    {
-        return 0;
     }
-
-    uint_fast64_t end_idx = *idx;
-    char c = 0;
-    while (1)
+    else
     {
-        c = buff[end_idx];
-        if (IS_END_CHAR(c))
+        JSONDict *jd = (JSONDict *)frame->json;
+        jd->reserve(nb_values);
+        for (uint_fast64_t i = 0; i < nb_values; ++i)
         {
-            break;
+            err |= jd->addInternedItem(values[i].getKey(),
+                                       *values[i].getValue())
+                & ~ERR_ITEM_EXISTS;
         }
-        ++end_idx;
     }
-    uint_fast64_t len = end_idx - *idx;
-    *idx += len - 1;
-    return len;
+    st->nb_values = frame->start;
+    return err;
 }
 
+/*******************************************************************************
+**                                 DOM BUILDER                                **
+*******************************************************************************/
 /**
-** \param buff The buffer containing the object currently being parsed
-** \param idx The index of the character just after the '[' that begins the
-**            current array
-** \returns The number of elements of the current array
+** \class DOMBuilder Handler that builds the json object of the input
+** \brief The containers are kept on a ParseStack while they are being read,
+**        and their values are moved into them when they are closed (see
+**        close_frame()). The strings that point into the input (when it is
+**        retained) are not copied
+** \param arena The arena in which the nodes and strings are allocated, nullptr
+**              to allocate them on the heap
+** \param keys The table in which the keys are interned (in the arena), nullptr
+**             to give each key its own String
+** \param err The error bits of the parsing
+** \param st The containers that are being read and their values
+** \param root The json object, nullptr until it is closed
 */
-uint_fast64_t get_nb_elts_array_buff(char *buff, uint_fast64_t idx,
-                                     uint_fast16_t *err)
+class DOMBuilder final : public Handler
 {
-    if (buff == nullptr || err == nullptr || buff[idx] == ']')
+private:
+    Arena *arena;
+    KeyTable *keys;
+    uint_fast16_t *err;
+    ParseStack st;
+    JSON *root;
+
+    Frame *top()
     {
-        return 0;
+        return st.frames + st.nb_frames - 1;
     }
 
-    uint_fast64_t nb_elts = 0;
-    uint_nested_arrays_t is_in_array = 1;
-    uint_nested_dicts_t is_in_dict = 0;
-    char c = 0;
-    char prev_c = 0;
-    char is_in_string = 0;
-    char is_backslashing = 0;
-    char comma_encountered = 0;
-    while (1)
+    String *makeString(const char *str, uint_fast64_t len, bool in_input)
     {
-        c = buff[idx];
-        if (!is_in_array || c == 0)
+        if (in_input)
         {
-            break;
+            return arena_new<String>(arena, str, len, false);
         }
 
-        if (c == '\\')
-        {
-            is_backslashing = !is_backslashing;
-        }
-        else if (!comma_encountered && c == ',' && is_in_array == 1)
+        if (arena == nullptr)
         {
-            comma_encountered = 1;
+            STATS_ALLOC(len + 1);
         }
+        char *copy = arena == nullptr ? new char[len + 1]
+                                      : (char *)arena->alloc(len + 1, 1);
+        std::memcpy(copy, str, len);
+        copy[len] = 0;
+        return arena_new<String>(arena, copy, len, arena == nullptr);
+    }
+
+    bool startContainer(bool is_array)
+    {
+        Frame *f = st.pushFrame();
+        f->json = is_array ? (JSON *)arena_new<JSONArray>(arena, arena)
+                           : arena_new<JSONDict>(arena, arena, keys);
+        f->is_array = is_array;
+        return true;
+    }
 
-        // If we are not in a string or if the string just ended
-        if (!is_in_string || (is_in_string && c == '"' && !is_backslashing))
+    /**
+    ** \brief Closes the top container and adds it to its parent (or makes it
+    **        the root if it has no parent)
+    */
+    bool endContainer()
+    {
+        Frame *f = top();
+        *err |= close_frame(&st, f);
+        if (*err)
         {
-            if (c == '"')
-            {
-                is_in_string = !is_in_string;
-            }
-            else if (c == '[')
-            {
-                if (max_nested_arrays_reached(is_in_array, err))
-                {
-                    return 0;
-                }
-                ++is_in_array;
-            }
-            else if (c == ']')
-            {
-                --is_in_array;
-            }
-            else if (c == '{')
-            {
-                if (max_nested_dicts_reached(is_in_dict, err))
-                {
-                    return 0;
-                }
-                ++is_in_dict;
-            }
-            else if (c == '}')
-            {
-                --is_in_dict;
-            }
-            else if (!is_in_dict && is_in_array == 1 && c == ',')
-            {
-                ++nb_elts;
-            }
+            return false;
         }
-        ++idx;
 
-        if (c != ' ' && c != '\t' && c != '\n')
+        JSON *child = f->json;
+        f->json = nullptr;
+        if (st.nb_frames == 1)
         {
-            prev_c = c;
+            st.nb_frames = 0;
+            root = child;
+            return true;
         }
+
+        f = st.popFrame();
+        add_value(&st, f,
+                  child->isArray() ? Value::fromArray((JSONArray *)child)
+                                   : Value::fromDict((JSONDict *)child));
+        return true;
     }
 
-    // If there was only one value, there was no ',', so the element wasn't
-    // detected or if at least one element was found, it means that a ',' was
-    // found
-    if ((nb_elts == 0 && prev_c != 0) || (nb_elts >= 1 && comma_encountered))
+public:
+    DOMBuilder(Arena *arena, uint_fast16_t *err, KeyTable *keys = nullptr)
+        : arena(arena)
+        , keys(keys)
+        , err(err)
+        , st(arena)
+        , root(nullptr)
+    {}
+
+    /**
+    ** \brief Frees the containers that were not closed (in case of error)
+    */
+    ~DOMBuilder()
     {
-        ++nb_elts;
+        st.freeContent();
     }
-    return nb_elts;
-}
 
-/**
-** \param buff The buffer containing the object currently being parsed
-** \param idx The index of the character just after the '{' that begins the
-**            current dict
-** \returns The number of elements of the current dict
-*/
-uint_fast64_t get_nb_elts_dict_buff(char *buff, uint_fast64_t idx,
-                                    uint_fast16_t *err)
-{
-    if (buff == nullptr || err == nullptr || idx >= MAX_READ_BUFF_SIZE
-        || buff[idx] == '}')
+    /**
+    ** \brief Forgets the json object and the containers that were being read,
+    **        to read another input with the same stacks. Only used with an
+    **        arena, which frees them (and the table of the keys, replaced by
+    **        'keys')
+    */
+    void reset(KeyTable *keys)
     {
-        return 0;
+        this->keys = keys;
+        st.nb_frames = 0;
+        st.nb_values = 0;
+        root = nullptr;
     }
 
-    uint_fast64_t nb_elts = 0;
-    // Used for the case where the dict contains only one element, and so does
-    // not contain a ','
-    uint_fast64_t single_elt_found = 0;
+    /**
+    ** \returns The json object, nullptr if it was not entirely read
+    */
+    JSON *getRoot()
+    {
+        return root;
+    }
 
-    uint_nested_dicts_t is_in_dict = 1;
-    uint_nested_arrays_t is_in_array = 0;
-    char is_in_string = 0;
-    char is_backslashing = 0;
-    char c = 0;
-    while (1)
+    /**
+    ** \brief Opens an array that has no container, whose values are some of
+    **        the elements of a larger array (see takeElements())
+    */
+    void startElements()
     {
-        c = buff[idx];
-        if (!is_in_dict || c == 0)
-        {
-            break;
-        }
+        st.pushFrame()->is_array = true;
+    }
 
-        if (c == '\\')
-        {
-            is_backslashing = !is_backslashing;
-        }
+    /**
+    ** \returns The number of elements read since startElements()
+    */
+    uint_fast64_t getNbElements()
+    {
+        return st.nb_values;
+    }
 
-        // If we are not in a string or if the string just ended
-        if (!is_in_string || (is_in_string && c == '"' && !is_backslashing))
+    /**
+    ** \brief Moves the elements read since startElements() at the end of the
+    **        given array
+    ** \returns The error bits set by JSONArray::addValue()
+    */
+    uint_fast16_t takeElements(JSONArray *ja)
+    {
+        uint_fast16_t e = 0;
+        for (uint_fast64_t i = 0; i < st.nb_values; ++i)
         {
-            if (c == '"')
-            {
-                is_in_string = !is_in_string;
-                single_elt_found = 1;
-            }
-            else if (c == '[')
-            {
-                if (max_nested_arrays_reached(is_in_array, err))
-                {
-                    return 0;
-                }
-                ++is_in_array;
-            }
-            else if (c == ']')
-            {
-                --is_in_array;
-            }
-            else if (c == '{')
-            {
-                if (max_nested_dicts_reached(is_in_dict, err))
-                {
-                    return 0;
-                }
-                ++is_in_dict;
-            }
-            else if (c == '}')
-            {
-                --is_in_dict;
-            }
-            else if (!is_in_array && is_in_dict == 1 && c == ',')
-            {
-                ++nb_elts;
-            }
+            e |= ja->addValue(*st.values[i].getValue());
         }
-        ++idx;
+        st.nb_values = 0;
+        st.nb_frames = 0;
+        return e;
     }
-    return nb_elts == 0 ? single_elt_found : nb_elts + 1;
-}
 
-/**
-** \param buff The buffer containing the object currently being parsed
-** \param idx The index of the character '[' that begins the current array
-** \returns The json array parsed from the position
-*/
-JSONArray *parse_array_buff(char *b, uint_fast64_t *idx, uint_fast16_t *err)
-{
-    if (b == nullptr || err == nullptr)
+    /**
+    ** \brief Adds a container of the input that is only parsed when it is
+    **        accessed (see LazyJSON)
+    */
+    bool addLazy(const char *chars, uint_fast64_t len, bool is_array)
     {
-        return nullptr;
+        add_value(&st, top(),
+                  Value::fromLazy(
+                      arena_new<LazyJSON>(arena, chars, len, is_array, arena)));
+        return true;
     }
 
-    uint_fast64_t i = idx == nullptr ? 0 : *idx + 1;
-
-    uint_fast64_t nb_elts_parsed = 0;
-    uint_fast64_t nb_elts = get_nb_elts_array_buff(b, i, err);
-    if (*err)
+    bool onStartArray() override
     {
-        return nullptr;
+        return startContainer(true);
     }
 
-    JSONArray *ja = new JSONArray();
-    if (nb_elts == 0)
+    bool onEndArray() override
     {
-        return ja;
+        return endContainer();
     }
 
-    char c = 0;
-    // We start at 1 because if we entered this function, it means that we
-    // already read a '['
-    uint_fast64_t initial_i = i;
-    while (1)
+    bool onStartObject() override
     {
-        c = b[i];
-        if (c == 0 || nb_elts_parsed >= nb_elts)
-        {
-            break;
-        }
-
-        if (c == '"')
-        {
-            ja->addValue(new StringValue(parse_string_buff(b, &i)));
-            ++nb_elts_parsed;
-        }
-        else if (IS_NUMBER_START(c))
-        {
-            StrAndLenTuple sl = parse_number_buff(b, &i);
-            if (sl.str == nullptr)
-            {
-                continue;
-            }
-
-            if (sl.is_float)
-            {
-                ja->addValue(new DoubleValue(str_to_double(&sl)));
-            }
-            else
-            {
-                ja->addValue(new IntValue(str_to_long(&sl)));
-            }
-            ++nb_elts_parsed;
-        }
-        else if (IS_BOOL_START(c))
-        {
-            uint_fast64_t len = parse_boolean_buff(b, &i);
-            if (IS_NOT_BOOLEAN(c, len))
-            {
-                continue;
-            }
-            ja->addValue(new BoolValue(len == 4 ? true : false));
-            ++nb_elts_parsed;
-        }
-        else if (c == 'n')
-        {
-            ja->addValue(new NullValue());
-            i += 3;
-            ++nb_elts_parsed;
-        }
-        else if (c == '[')
-        {
-            JSONArray *tmp_ja = parse_array_buff(b, &i, err);
-            if (tmp_ja == nullptr)
-            {
-                *err = 1;
-                break;
-            }
-            ja->addValue(new ArrayValue(tmp_ja));
-            ++nb_elts_parsed;
-        }
-        else if (c == '{')
-        {
-            JSONDict *tmp_jd = parse_dict_buff(b, &i, err);
-            if (tmp_jd == nullptr)
-            {
-                *err = 1;
-                break;
-            }
-            ja->addValue(new DictValue(tmp_jd));
-            ++nb_elts_parsed;
-        }
-        ++i;
+        return startContainer(false);
     }
-    if (*err)
+
+    bool onEndObject() override
     {
-        delete ja;
-        return nullptr;
+        return endContainer();
     }
-    if (idx != nullptr)
+
+    bool onKey(const char *str, uint_fast64_t len, bool in_input) override
     {
-        *idx += i - initial_i;
+        top()->key = keys == nullptr ? makeString(str, len, in_input)
+                                     : keys->intern(str, len, in_input);
+        return true;
     }
-    return ja;
-}
 
-/**
-** \param b The buffer containing the object currently being parsed
-** \param idx A pointer to the index of the character '{' that begins the
-**            current dict.
-**            If the given pointer is a nullptr, it means that the buffer is a
-**            new one created just before calling this function, meaning the
-**            index starts at 0
-** \returns The json dict parsed from the index
-*/
-JSONDict *parse_dict_buff(char *b, uint_fast64_t *idx, uint_fast16_t *err)
-{
-    if (b == nullptr || err == nullptr)
+    bool onString(const char *str, uint_fast64_t len, bool in_input) override
     {
-        return nullptr;
+        add_value(&st, top(), Value::fromString(makeString(str, len, in_input)));
+        return true;
     }
 
-    uint_fast64_t i = idx == nullptr ? 0 : *idx + 1;
+    bool onInt(int_fast64_t i) override
+    {
+        add_value(&st, top(), Value::fromInt(i));
+        return true;
+    }
 
-    uint_fast64_t nb_elts_parsed = 0;
-    uint_fast64_t nb_elts = get_nb_elts_dict_buff(b, i, err);
-    if (*err)
+    bool onDouble(double d) override
     {
-        return nullptr;
+        add_value(&st, top(), Value::fromDouble(d));
+        return true;
     }
 
-    JSONDict *jd = new JSONDict();
-    if (nb_elts == 0)
+    bool onBool(bool b) override
     {
-        return jd;
+        add_value(&st, top(), Value::fromBool(b));
+        return true;
     }
 
-    String *key = nullptr;
-    char c = 0;
-    char is_waiting_key = 1;
-    // We start at 1 because if we entered this function, it means that we
-    // already read a '{'
-    uint_fast64_t initial_i = i;
-    while (1)
+    bool onNull() override
     {
-        c = b[i];
-        if (c == 0 || nb_elts_parsed >= nb_elts)
-        {
-            break;
-        }
+        add_value(&st, top(), Value());
+        return true;
+    }
+};
 
-        if (c == '"')
-        {
-            if (is_waiting_key)
-            {
-                key = parse_string_buff(b, &i);
-                is_waiting_key = 0;
-            }
-            else
-            {
-                jd->addItem(new StringItem(key, parse_string_buff(b, &i)));
-                ++nb_elts_parsed;
-            }
-        }
-        else if (IS_NUMBER_START(c))
-        {
-            StrAndLenTuple sl = parse_number_buff(b, &i);
-            if (sl.str == nullptr)
-            {
-                continue;
-            }
+/**
+** \brief Gives a lazy container to the handler. Only the documents are parsed
+**        lazily, so this is only called for their DOMBuilder
+*/
+bool add_lazy(DOMBuilder *builder, const char *chars, uint_fast64_t len,
+              bool is_array)
+{
+    return builder->addLazy(chars, len, is_array);
+}
 
-            if (sl.is_float)
-            {
-                jd->addItem(new DoubleItem(key, str_to_double(&sl)));
-            }
-            else
-            {
-                jd->addItem(new IntItem(key, str_to_long(&sl)));
-            }
-            ++nb_elts_parsed;
-        }
-        else if (IS_BOOL_START(c))
-        {
-            uint_fast64_t len = parse_boolean_buff(b, &i);
-            if (IS_NOT_BOOLEAN(c, len))
-            {
-                continue;
-            }
-            jd->addItem(new BoolItem(key, len == 4 ? true : false));
-            ++nb_elts_parsed;
-        }
-        else if (c == 'n')
-        {
-            jd->addItem(new NullItem(key));
-            i += 3;
-            ++nb_elts_parsed;
-        }
-        else if (c == '[')
-        {
-            JSONArray *tmp_ja = parse_array_buff(b, &i, err);
-            if (tmp_ja == nullptr)
-            {
-                *err = 1;
-                break;
-            }
-            jd->addItem(new ArrayItem(key, tmp_ja));
-            ++nb_elts_parsed;
-        }
-        else if (c == '{')
-        {
-            JSONDict *tmp_jd = parse_dict_buff(b, &i, err);
-            if (tmp_jd == nullptr)
-            {
-                *err = 1;
-                break;
-            }
-            jd->addItem(new DictItem(key, tmp_jd));
-            ++nb_elts_parsed;
-        }
-        else if (c == ',')
-        {
-            is_waiting_key = 1;
-        }
-        ++i;
-    }
-    if (*err)
-    {
-        delete jd;
-        return nullptr;
-    }
-    if (idx != nullptr)
-    {
-        *idx += i - initial_i;
-    }
-    return jd;
+bool add_lazy(Handler *, const char *, uint_fast64_t, bool)
+{
+    return false;
 }
 
+/*******************************************************************************
+**                                TAPE BUILDER                                **
+*******************************************************************************/
 /**
-** \brief Parses the string starting at 'pos + 1' (first char after the '"')
-** \param f The file stream
-** \param pos A pointer to the uint_fast64_t containing the position of the '"'
-**            that started the string we want to parse
-** \returns An empty string in case of error, the parsed string otherwise
+** \class TapeBuilder Handler that writes the values of the input in a tape
+**                    (see Tape)
+** \brief The containers that are being read are kept on a stack, their first
+**        word is completed when they are closed. In the meantime, their second
+**        word counts their values and keys (so twice the number of items of a
+**        dict). The strings are always copied, the tape doesn't keep its input
+** \param tape The tape in which the values are written
+** \param open The positions of the first words of the containers that are
+**             being read, the last one being the innermost
 */
-String *parse_string(FILE *f, uint_fast64_t *pos)
+class TapeBuilder final : public Handler
 {
-    if (f == nullptr || pos == nullptr)
-    {
-        return nullptr;
-    }
+private:
+    Tape *tape;
+    ArrayList<uint_fast64_t> open;
 
-    uint_fast64_t i = *pos;
-    char c = 0;
-    char prev_c = 0;
-    while (SEEK_AND_GET_CHAR(i) && !IS_STRING_END(c))
+    /**
+    ** \brief Counts a value or a key in the container that is being read
+    */
+    void count()
     {
-        prev_c = c;
+        uint_fast64_t depth = open.getSize();
+        if (depth > 0)
+        {
+            ++tape->getWords()[*open.get(depth - 1) + 1];
+        }
     }
 
-    uint_strlen_t len = i - *pos - 1 > MAX_STR_LEN ? 0 : i - *pos - 1;
-    if (len == 0)
+    bool startContainer(unsigned char tag)
     {
-        return nullptr;
+        count();
+        open.add(tape->getNbWords());
+        // The position of the end is only known when the container is closed
+        tape->addWords(TAPE_WORD(tag, 0), 0);
+        return true;
     }
 
-    char *str = new char[len + 1]();
-    if (str == nullptr)
+    bool endContainer(unsigned char tag)
     {
-        return nullptr;
+        uint_fast64_t depth = open.getSize();
+        uint_fast64_t start = *open.get(depth - 1);
+        open.remove(depth - 1);
+
+        uint_fast64_t end = tape->getNbWords();
+        tape->addWord(TAPE_WORD(TAPE_END, start));
+        uint64_t *words = tape->getWords();
+        words[start] = TAPE_WORD(tag, end);
+        if (tag == T_DICT)
+        {
+            words[start + 1] /= 2;
+        }
+        return true;
     }
 
-    if (fseek(f, *pos, SEEK_SET) != 0)
+    bool addString(const char *str, uint_fast64_t len)
     {
-        delete[] str;
-        return nullptr;
+        count();
+        tape->addWords(TAPE_WORD(T_STR, tape->addChars(str, len)), len);
+        return true;
     }
-    fread(str, sizeof(char), len, f);
 
-    // +1 to not read the last '"' when returning in the calling function
-    *pos += len + 1;
-    return new String(str, len);
-}
+public:
+    TapeBuilder(Tape *tape)
+        : tape(tape)
+    {}
 
-/**
-** \brief Reads the file from the given pos and returns an instance of the
-**        StrAndLenTuple class containing the number as a char array, the length
-**        of the char array and whether the number is a float and has an
-**        exponent
-** \param f The file stream
-** \param pos The pos of the start of the number of which we are currently
-**            acquiring the length
-*/
-StrAndLenTuple parse_number(FILE *f, uint_fast64_t *pos)
-{
-    if (f == nullptr || pos == nullptr)
+    bool onStartArray() override
     {
-        return StrAndLenTuple();
+        return startContainer(T_ARR);
     }
 
-    // Obtains the length of the value
-    // -1 because we already read the first digit (or sign)
-    uint_fast64_t end_pos = *pos - 1;
+    bool onEndArray() override
+    {
+        return endContainer(T_ARR);
+    }
 
-    char c = 0;
-    // end_pos is incremented for each character found to be part of a number
-    while (SEEK_AND_GET_CHAR(end_pos) && !IS_END_CHAR(c))
+    bool onStartObject() override
     {
+        return startContainer(T_DICT);
     }
 
-    uint_fast64_t len = end_pos - *pos;
-    if (len == 0)
+    bool onEndObject() override
     {
-        return StrAndLenTuple();
+        return endContainer(T_DICT);
     }
 
-    // Puts the value in the form of a char array
-    char *str = new char[len + 1]();
-    // If the allocation failed
-    if (str == nullptr)
+    bool onKey(const char *str, uint_fast64_t len, bool) override
     {
-        return StrAndLenTuple();
+        return addString(str, len);
     }
 
-    // If we couldn't set the pos in the file
-    if (fseek(f, *pos - 1, SEEK_SET) != 0)
+    bool onString(const char *str, uint_fast64_t len, bool) override
     {
-        delete[] str;
-        return StrAndLenTuple();
+        return addString(str, len);
     }
-    fread(str, sizeof(char), len, f);
 
-    *pos += len - 1;
-    return StrAndLenTuple(str, len, is_float(str, len), has_exponent(str, len));
-}
+    bool onInt(int_fast64_t i) override
+    {
+        count();
+        tape->addWords(TAPE_WORD(T_INT, 0), (uint64_t)i);
+        return true;
+    }
 
-/**
-** \returns 5 if false, 4 if true, 0 otherwise
-**/
-uint_fast64_t parse_boolean(FILE *f, uint_fast64_t *pos)
-{
-    if (f == nullptr || pos == nullptr)
+    bool onDouble(double d) override
     {
-        return 0;
+        count();
+        uint64_t bits = 0;
+        std::memcpy(&bits, &d, sizeof(double));
+        tape->addWords(TAPE_WORD(T_DOUBLE, 0), bits);
+        return true;
     }
 
-    // -1 because we already read the first character
-    uint_fast64_t end_pos = *pos - 1;
+    bool onBool(bool b) override
+    {
+        count();
+        tape->addWord(TAPE_WORD(T_BOOL, b));
+        return true;
+    }
 
-    char c = 0;
-    // end_pos is incremented for each character found to be part of a boolean
-    while (SEEK_AND_GET_CHAR(end_pos) && !IS_END_CHAR(c))
+    bool onNull() override
     {
+        count();
+        tape->addWord(TAPE_WORD(T_NULL, 0));
+        return true;
     }
-    uint_fast64_t len = end_pos - *pos;
-    *pos += len - 1;
-    return len;
-}
+};
 
+/*******************************************************************************
+**                                   PARSING                                  **
+*******************************************************************************/
 /**
-** \param f The file stream
-** \param pos The position in the file of the character after the '[' that
-**            begins the current array
-** \param err A pointer to a char that will be updated if an error occurs
-**            (we return the number of chars, so we can't use a number to
-**            indicate an error)
-** \returns The total number of characters in the current array - 1 (the first
-**          '[' is not counted)
+** \brief Reads the string, number, boolean or null that starts at the cursor
+**        of the reader and gives it to the handler
+** \param r The reader, whose cursor is left on the last character of the
+**          value
+** \param ok Set to the result of the handler
+** \returns false if the characters at the cursor are not a valid value, or if
+**          a number, boolean or null is followed by something else than a
+**          whitespace, a ',', a ']' or a '}'
 */
-uint_fast64_t get_nb_chars_in_array(FILE *f, uint_fast64_t pos,
-                                    uint_fast16_t *err)
+template <class H>
+bool parse_scalar(Reader *r, H *h, Scratch *scratch, bool *ok)
 {
-    if (f == nullptr || err == nullptr)
+    char c = r->data[r->pos];
+    if (c == '"')
     {
-        return 0;
+        const char *str = nullptr;
+        uint_fast64_t len = 0;
+        bool escaped = false;
+        // The input can end inside the string
+        if (!read_string(r, scratch, &str, &len, &escaped))
+        {
+            return false;
+        }
+        STATS_ADD(nb_strings, 1);
+        *ok = h->onString(str, len, r->retained && !escaped);
     }
-
-    uint_fast64_t nb_chars = 0;
-
-    uint_nested_arrays_t is_in_array = 1;
-    uint_nested_dicts_t is_in_dict = 0;
-    char is_in_string = 0;
-    char is_backslashing = 0;
-
-    char c = 0;
-    while (SEEK_AND_GET_CHAR(pos))
+    else if (IS_NUMBER_START(c))
     {
-        if (c == '\\')
+        Number n;
+        if (!parse_number(r, &n) || !is_scalar_end(r))
         {
-            is_backslashing = !is_backslashing;
+            return false;
         }
-
-        // If we are not in a string or if the string just ended
-        if (!is_in_string || (is_in_string && c == '"' && !is_backslashing))
+        STATS_ADD(nb_doubles, n.is_float);
+        STATS_ADD(nb_ints, !n.is_float);
+        *ok = n.is_float ? h->onDouble(n.d) : h->onInt(n.i);
+    }
+    else if (IS_BOOL_START(c)
+             && (IS_LITERAL(r, "true", 4) || IS_LITERAL(r, "false", 5)))
+    {
+        bool v = c == 't';
+        r->pos += v ? 3 : 4;
+        if (!is_scalar_end(r))
         {
-            if (c == '"')
-            {
-                is_in_string = !is_in_string;
-            }
-            else if (c == '[')
-            {
-                if (max_nested_arrays_reached(is_in_array, err))
-                {
-                    return 0;
-                }
-                ++is_in_array;
-            }
-            else if (c == ']')
-            {
-                --is_in_array;
-            }
-            else if (c == '{')
-            {
-                if (max_nested_dicts_reached(is_in_dict, err))
-                {
-                    return 0;
-                }
-                ++is_in_dict;
-            }
-            else if (c == '}')
-            {
-                --is_in_dict;
-            }
+            return false;
         }
-        ++nb_chars;
-
-        if (!is_in_array)
+        STATS_ADD(nb_bools, 1);
+        *ok = h->onBool(v);
+    }
+    else if (c == 'n' && IS_LITERAL(r, "null", 4))
+    {
+        r->pos += 3;
+        if (!is_scalar_end(r))
         {
-            break;
+            return false;
         }
+        STATS_ADD(nb_nulls, 1);
+        *ok = h->onNull();
     }
-    return nb_chars;
+    else
+    {
+        return false;
+    }
+    return true;
 }
 
 /**
-** \param f The file stream
-** \param pos The position in the file of the character just after the '[' that
-**            begins the current array
-** \returns The number of elements of the current array
+** \brief Reads the array or dict that starts at the cursor of the reader in a
+**        single pass, and calls the handler for each of its tokens. The
+**        handler is a template parameter so that the calls to the DOMBuilder
+**        are not virtual.
+**        If the reader is lazy, the nested containers are not read but given
+**        to the handler with add_lazy()
+** \param r The reader, whose cursor is on the '[' or '{' that begins the
+**          container. It is left on the matching ']' or '}' (at the end of
+**          the input for the root)
+** \param is_root Whether the container is the root of the input, which must
+**                only be followed by whitespaces
+** \param buffers The buffers to use, nullptr to allocate new ones
+** \returns false in case of error (in which case the error bits are set in
+**          'err'), or if the handler stopped the parsing
 */
-uint_fast64_t get_nb_elts_array(FILE *f, uint_fast64_t pos, uint_fast16_t *err)
+template <class H>
+bool parse_container(Reader *r, H *h, uint_fast16_t *err, bool is_root,
+                     ParseBuffers *buffers = nullptr)
 {
-    if (f == nullptr || err == nullptr)
+    if (r == nullptr || h == nullptr || err == nullptr)
     {
-        return 0;
+        return false;
     }
 
-    uint_fast64_t nb_elts = 0;
-
-    uint_nested_arrays_t is_in_array = 1;
-    uint_nested_dicts_t is_in_dict = 0;
-    char is_in_string = 0;
-    char is_backslashing = 0;
-    char comma_encountered = 0;
+    ParseBuffers local;
+    ParseBuffers *b = buffers == nullptr ? &local : buffers;
+    ArrayList<Level> *levels = &b->levels;
+    levels->clear();
+    uint_nested_arrays_t nb_arrays = 0;
+    uint_nested_dicts_t nb_dicts = 0;
 
-    char c = 0;
-    char prev_c = 0;
-    while (SEEK_AND_GET_CHAR(pos))
+    bool ok = true;
+    while (1)
     {
-        if (!is_in_array)
+        if (r->pos >= r->len && !r->refill())
         {
+            // The input ended before the first container was closed
+            *err |= ERR_INVALID_JSON;
             break;
         }
 
-        if (c == '\\')
-        {
-            is_backslashing = !is_backslashing;
-        }
-        else if (!comma_encountered && c == ',' && is_in_array == 1)
+        char c = r->data[r->pos];
+        if (IS_WHITESPACE(c))
         {
-            comma_encountered = 1;
+            r->advance();
+            continue;
         }
 
-        // If we are not in a string or if the string just ended
-        if (!is_in_string || (is_in_string && c == '"' && !is_backslashing))
+        uint_fast64_t depth = levels->getSize();
+        Level *top = depth == 0 ? nullptr : levels->get(depth - 1);
+        if (c == ',' || c == ':')
         {
-            if (c == '"')
+            if (top == nullptr || !top->readSeparator(c))
             {
-                is_in_string = !is_in_string;
+                *err |= ERR_INVALID_JSON;
+                break;
             }
-            else if (c == '[')
+            r->advance();
+            continue;
+        }
+
+        if (c == ']' || c == '}')
+        {
+            if (top == nullptr || (c == ']') != top->is_array
+                || !top->canClose())
             {
-                if (max_nested_arrays_reached(is_in_array, err))
-                {
-                    return 0;
-                }
-                ++is_in_array;
+                *err |= ERR_INVALID_JSON;
+                break;
             }
-            else if (c == ']')
+            // Checked before the root is given to the handler, which then
+            // still frees it in case of error
+            if (depth == 1 && is_root && !is_input_end(r))
             {
-                // Empty array
-                // TODO: Remove this and put it at the top like in the buffered
-                // version
-                if (is_in_array == 1 && prev_c == 0)
-                {
-                    return 0;
-                }
-                --is_in_array;
+                *err |= ERR_INVALID_JSON;
+                break;
             }
-            else if (c == '{')
+
+            levels->remove(depth - 1);
+            if (c == ']')
             {
-                if (max_nested_dicts_reached(is_in_dict, err))
-                {
-                    return 0;
-                }
-                ++is_in_dict;
+                --nb_arrays;
+                ok = h->onEndArray();
             }
-            else if (c == '}')
+            else
             {
-                --is_in_dict;
+                --nb_dicts;
+                ok = h->onEndObject();
             }
-            else if (!is_in_dict && is_in_array == 1 && c == ',')
+            if (ok && depth == 1)
             {
-                ++nb_elts;
+                return true;
             }
         }
-
-        if (c != ' ' && c != '\t' && c != '\n')
+        else if (top != nullptr && top->wantsKey())
         {
-            prev_c = c;
-        }
-    }
-
-    // If there was only one value, there was no ',', so the element wasn't
-    // detected or if at least one element was found, it means that a ',' was
-    // found
-    if ((nb_elts == 0 && prev_c != 0) || (nb_elts >= 1 && comma_encountered))
-    {
-        ++nb_elts;
-    }
-    return nb_elts;
-}
-
-/**
-** \param f The file stream
-** \param pos The position in the file of the character after the '{' that
-**            begins the current dict
-** \returns The total number of characters in the current dict - 1 (the first
-**          '{' is not counted)
-*/
-uint_fast64_t get_nb_chars_in_dict(FILE *f, uint_fast64_t pos,
-                                   uint_fast16_t *err)
-{
-    if (f == nullptr || err == nullptr)
-    {
-        return 0;
-    }
-
-    uint_fast64_t nb_chars = 0;
+            // A dict that waits for a key only accepts a key or its end
+            if (c != '"')
+            {
+                *err |= ERR_NULL_KEY;
+                break;
+            }
 
-    uint_nested_dicts_t is_in_dict = 1;
-    uint_nested_arrays_t is_in_array = 0;
-    char is_in_string = 0;
-    char is_backslashing = 0;
+            const char *str = nullptr;
+            uint_fast64_t len = 0;
+            bool escaped = false;
+            if (!read_string(r, &b->scratch, &str, &len, &escaped))
+            {
+                // The input ended inside the key
+                *err |= ERR_INVALID_JSON;
+                break;
+            }
 
-    char c = 0;
-    while (SEEK_AND_GET_CHAR(pos))
-    {
-        if (c == '\\')
+            top->expect = EXPECT_COLON;
+            STATS_ADD(nb_keys, 1);
+            ok = h->onKey(str, len, r->retained && !escaped);
+        }
+        else if (top != nullptr && !top->wantsValue())
         {
-            is_backslashing = !is_backslashing;
+            // A value that is not separated from the previous one
+            *err |= ERR_INVALID_JSON;
+            break;
         }
-
-        // If we are not in a string or if the string just ended
-        if (!is_in_string || (is_in_string && c == '"' && !is_backslashing))
+        else if (c == '[' || c == '{')
         {
-            if (c == '"')
+            if (c == '[' ? max_nested_arrays_reached(nb_arrays, err)
+                         : max_nested_dicts_reached(nb_dicts, err))
             {
-                is_in_string = !is_in_string;
-            }
-            else if (c == '[')
-            {
-                if (max_nested_arrays_reached(is_in_array, err))
-                {
-                    return 0;
-                }
-                ++is_in_array;
+                break;
             }
-            else if (c == ']')
+            if (top != nullptr)
             {
-                --is_in_array;
+                top->expect = EXPECT_COMMA;
             }
-            else if (c == '{')
+
+            if (r->lazy && top != nullptr)
             {
-                if (max_nested_dicts_reached(is_in_dict, err))
+                // The container is only parsed when it is accessed
+                uint_fast64_t start = r->pos;
+                if (!skip_container(r))
                 {
-                    return 0;
+                    *err |= ERR_INVALID_JSON;
+                    break;
                 }
-                ++is_in_dict;
+                // Its characters are read again when it is parsed
+                STATS_ADD(rescanned_bytes, r->pos - start + 1);
+                ok = add_lazy(h, r->data + start, r->pos - start + 1,
+                              c == '[');
             }
-            else if (c == '}')
+            else
             {
-                --is_in_dict;
+                Level level;
+                level.is_array = c == '[';
+                level.expect = EXPECT_FIRST;
+                levels->add(level);
+                STATS_MAX(max_depth, levels->getSize());
+                if (c == '[')
+                {
+                    ++nb_arrays;
+                    STATS_ADD(nb_arrays, 1);
+                    ok = h->onStartArray();
+                }
+                else
+                {
+                    ++nb_dicts;
+                    STATS_ADD(nb_dicts, 1);
+                    ok = h->onStartObject();
+                }
             }
         }
-        ++nb_chars;
+        else if (top != nullptr && parse_scalar(r, h, &b->scratch, &ok))
+        {
+            top->expect = EXPECT_COMMA;
+        }
+        else
+        {
+            *err |= ERR_INVALID_JSON;
+            break;
+        }
 
-        if (!is_in_dict)
+        if (!ok)
         {
+            // The DOMBuilder sets its own error bits
+            *err |= *err == 0 ? ERR_HANDLER_STOPPED : 0;
             break;
         }
+        r->advance();
     }
-    return nb_chars;
+    return false;
 }
 
 /**
-** \param f The file stream
-** \param pos The position in the file of the character just after the '{' that
-**            begins the current dict
-** \returns The number of elements of the current dict
+** \brief Reads the json array or dict that starts at the cursor of the reader
+**        (after the whitespaces)
+** \param buffers The buffers of parse_container(), nullptr to allocate new
+**                ones
+** \returns false if the input does not start with a '{' or a '[', if
+**          something else than whitespaces follows the container, in case of
+**          error or if the handler stopped the parsing
 */
-uint_fast64_t get_nb_elts_dict(FILE *f, uint_fast64_t pos, uint_fast16_t *err)
+template <class H>
+bool parse_root(Reader *r, H *h, uint_fast16_t *err,
+                ParseBuffers *buffers = nullptr)
 {
-    if (f == nullptr || err == nullptr)
+    if (r == nullptr || err == nullptr)
+    {
+        return false;
+    }
+
+    if (r->index != nullptr)
     {
-        return 0;
+        // The first token is the first character that is not a whitespace
+        r->advance();
+    }
+    while (r->ensure(1) && IS_WHITESPACE(r->data[r->pos]))
+    {
+        ++r->pos;
+    }
+
+    if (!r->ensure(1))
+    {
+        return false;
     }
 
-    uint_fast64_t nb_elts = 0;
+    char c = r->data[r->pos];
+    if (c != '{' && c != '[')
+    {
+        return false;
+    }
+    return parse_container(r, h, err, true, buffers);
+}
 
-    uint_nested_dicts_t is_in_dict = 1;
-    uint_nested_arrays_t is_in_array = 0;
-    char is_in_string = 0;
-    char is_backslashing = 0;
-    // Used for the case where the dict contains only one element, and so does
-    // not contain a ','
-    char single_elt_found = 0;
+/**
+** \brief Reads the elements of an array that are in the input of the reader
+**        (the characters between two of its top-level commas, without its
+**        brackets), and gives them to the handler
+** \returns false in case of error, or if the elements are not separated by
+**          commas
+*/
+template <class H>
+bool parse_elements(Reader *r, H *h, uint_fast16_t *err)
+{
+    if (r->index != nullptr)
+    {
+        r->advance();
+    }
 
-    char c = 0;
-    while (SEEK_AND_GET_CHAR(pos))
+    Scratch scratch;
+    // The elements are read like the values of an array without brackets
+    Level level;
+    level.is_array = true;
+    level.expect = EXPECT_FIRST;
+    bool ok = true;
+    while (r->pos < r->len || r->refill())
     {
-        if (c == '\\')
+        char c = r->data[r->pos];
+        if (IS_WHITESPACE(c))
+        {
+            r->advance();
+            continue;
+        }
+        if (c == ',' && level.readSeparator(c))
+        {
+            r->advance();
+            continue;
+        }
+        // A ',' that doesn't follow an element, or an element that doesn't
+        // follow a ','
+        if (c == ',' || !level.wantsValue())
         {
-            is_backslashing = !is_backslashing;
+            *err |= ERR_INVALID_JSON;
+            return false;
         }
 
-        // If we are not in a string or if the string just ended
-        if (!is_in_string || (is_in_string && c == '"' && !is_backslashing))
+        level.expect = EXPECT_COMMA;
+        if (c == '[' || c == '{')
         {
-            if (c == '"')
-            {
-                is_in_string = !is_in_string;
-                single_elt_found = 1;
-            }
-            else if (c == '[')
-            {
-                if (max_nested_arrays_reached(is_in_array, err))
-                {
-                    return 0;
-                }
-                ++is_in_array;
-            }
-            else if (c == ']')
-            {
-                --is_in_array;
-            }
-            else if (c == '{')
-            {
-                if (max_nested_dicts_reached(is_in_dict, err))
-                {
-                    return 0;
-                }
-                ++is_in_dict;
-            }
-            else if (c == '}')
-            {
-                --is_in_dict;
-            }
-            else if (!is_in_array && is_in_dict == 1 && c == ',')
-            {
-                ++nb_elts;
-            }
+            // Sets the error bits itself
+            ok = parse_container(r, h, err, false);
+        }
+        else if (!parse_scalar(r, h, &scratch, &ok))
+        {
+            *err |= ERR_INVALID_JSON;
+            return false;
         }
 
-        if (!is_in_dict)
+        if (!ok)
         {
-            break;
+            return false;
         }
+        r->advance();
+    }
+    // A ',' at the end of the elements has no value after it
+    if (!level.canClose())
+    {
+        *err |= ERR_INVALID_JSON;
+        return false;
     }
-    return nb_elts == 0 ? single_elt_found : nb_elts + 1;
+    return true;
 }
 
+#ifndef DISABLE_MMAP
 /**
-** \param f The file stream
-** \param pos The postion in the file of the character after the '[' that begins
-**            the current array
-** \returns The json array parsed from the position
+** \brief Maps the given regular file in memory and reads it directly from the
+**        mapping, which avoids copying the file into the heap
+** \param fd The file descriptor of the file to read
+** \param size The size of the file
+** \param mapped Set to false if the file could not be mapped, in which case
+**               the caller has to read it another way
+** \param doc The document that keeps the mapping alive for the strings that
+**            point into it, nullptr to unmap it after the parsing
+** \param lazy Whether the nested containers are only parsed when they are
+**             accessed (only if there is a document to keep the mapping alive)
 */
-JSONArray *parse_array(FILE *f, uint_fast64_t *pos, uint_fast16_t *err)
+template <class H>
+bool parse_mmap(int fd, uint_fast64_t size, bool *mapped, H *h, Document *doc,
+                bool lazy, uint_fast16_t *err)
 {
-    if (f == nullptr || pos == nullptr || err == nullptr)
+    STATS_START(start);
+    void *map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED)
     {
-        return nullptr;
+        *mapped = false;
+        return false;
     }
+    *mapped = true;
 
-    uint_fast64_t i = *pos;
+    // Only hints to the kernel, so the errors are ignored
+    madvise(map, size, MADV_SEQUENTIAL);
+#    if defined(MMAP_HUGE_PAGES) && defined(MADV_HUGEPAGE)
+    madvise(map, size, MADV_HUGEPAGE);
+#    endif
+    STATS_STOP(io_ns, start);
+    STATS_ADD(bytes_read, size);
 
-    uint_fast64_t nb_elts_parsed = 0;
-    uint_fast64_t nb_elts = get_nb_elts_array(f, i, err);
-    if (*err)
+    Reader r((const char *)map, size);
+    r.lazy = lazy && doc != nullptr;
+    r.retained = RETAIN_INPUT(doc) || r.lazy;
+    bool ok = parse_root(&r, h, err);
+    if (ok && r.retained)
     {
-        return nullptr;
+        doc->retainInput((const char *)map, size, true);
     }
-
-    JSONArray *ja = new JSONArray();
-    if (nb_elts == 0)
+    else
     {
-        ++(*pos);
-        return ja;
+        munmap(map, size);
     }
+    return ok;
+}
+#endif // !DISABLE_MMAP
 
-    char c = 0;
-    while (SEEK_AND_GET_CHAR(i) && nb_elts_parsed < nb_elts && c != 0)
-    {
-        // If we are not in a string or if the string just ended
-        if (c == '"')
-        {
-            *err |= ja->addValue(new StringValue(parse_string(f, &i)));
-            ++nb_elts_parsed;
+/**
+** \brief Reads the given file stream. Regular files that are smaller than
+**        MAX_READ_BUFF_SIZE are read entirely in a buffer, the other ones (and
+**        the streams that are not regular files, like pipes) are read through
+**        the window of a Reader, which keeps the memory used for the input
+**        bounded
+** \param f The file stream
+** \param nb_chars The size of the file, 0 if it is unknown
+** \param doc The document that keeps the read buffer alive for the strings
+**            that point into it, nullptr to free it after the parsing
+** \param lazy Whether the nested containers are only parsed when they are
+**             accessed (only if there is a document to keep the buffer alive,
+**             the streams read through a window are always parsed entirely)
+*/
+template <class H>
+bool parse_file(FILE *f, uint_fast64_t nb_chars, H *h, Document *doc,
+                bool lazy, uint_fast16_t *err)
+{
+    if (0 < nb_chars && nb_chars < MAX_READ_BUFF_SIZE)
+    {
+        STATS_ALLOC(nb_chars);
+        char *b = new char[nb_chars];
+        STATS_START(start);
+        uint_fast64_t nb_read = fread(b, sizeof(char), nb_chars, f);
+        STATS_STOP(io_ns, start);
+        STATS_ADD(bytes_read, nb_read);
+        Reader r(b, nb_read);
+        r.lazy = lazy && doc != nullptr;
+        r.retained = RETAIN_INPUT(doc) || r.lazy;
+        bool ok = parse_root(&r, h, err);
+        if (ok && r.retained)
+        {
+            doc->retainInput(b, nb_read, false);
         }
-        else if (IS_NUMBER_START(c))
+        else
         {
-            StrAndLenTuple sl = parse_number(f, &i);
-            if (sl.str == nullptr)
-            {
-                continue;
-            }
-
-            if (sl.is_float)
-            {
-                *err |= ja->addValue(new DoubleValue(str_to_double(&sl)));
-            }
-            else
-            {
-                *err |= ja->addValue(new IntValue(str_to_long(&sl)));
-            }
-            ++nb_elts_parsed;
+            delete[] b;
         }
-        else if (IS_BOOL_START(c))
-        {
-            uint_fast64_t len = parse_boolean(f, &i);
-            if (IS_NOT_BOOLEAN(c, len))
-            {
-                continue;
-            }
-            *err |= ja->addValue(new BoolValue(len == 4 ? true : false));
-            ++nb_elts_parsed;
-        }
-        else if (c == 'n')
-        {
-            *err |= ja->addValue(new NullValue());
-            i += 3;
-            ++nb_elts_parsed;
-        }
-        else if (c == '[')
-        {
-            uint_fast64_t nb_chars = get_nb_chars_in_array(f, i, err);
-            if (*err)
-            {
-                break;
-            }
+        return ok;
+    }
 
-            JSONArray *tmp_ja = nullptr;
-            // If there is enough space, we fill a buffer to read from it
-            if (nb_chars < MAX_READ_BUFF_SIZE)
-            {
-                char *b = new char[nb_chars + 1]();
-                if (fseek(f, i, SEEK_SET) != 0)
-                {
-                    *err = 1;
-                    delete[] b;
-                    break;
-                }
-                fread(b, sizeof(char), nb_chars, f);
-                tmp_ja = parse_array_buff(b, nullptr, err);
-                delete[] b;
-                i += nb_chars;
-            }
-            else
-            {
-                tmp_ja = parse_array(f, &i, err);
-            }
+    Reader r(f);
+    return parse_root(&r, h, err);
+}
 
-            *err |= ja->addValue(new ArrayValue(tmp_ja));
-            ++nb_elts_parsed;
-        }
-        else if (c == '{')
-        {
-            uint_fast64_t nb_chars = get_nb_chars_in_dict(f, i, err);
-            if (*err)
-            {
-                break;
-            }
+/**
+** \brief Reads the given file and calls the handler for each of its tokens
+** \param doc The document that keeps the input alive, or nullptr
+*/
+template <class H>
+bool parse_path(char *file, H *h, Document *doc, bool lazy,
+                uint_fast16_t *err)
+{
+    int fd = open(file, O_RDONLY);
+    if (fd == -1)
+    {
+        return false;
+    }
 
-            JSONDict *tmp_jd = nullptr;
-            // If there is enough space, we fill a buffer to read from it
-            if (nb_chars < MAX_READ_BUFF_SIZE)
-            {
-                char *b = new char[nb_chars + 1]();
-                if (fseek(f, i, SEEK_SET) != 0)
-                {
-                    *err = 1;
-                    delete[] b;
-                    break;
-                }
-                fread(b, sizeof(char), nb_chars, f);
-                tmp_jd = parse_dict_buff(b, nullptr, err);
-                delete[] b;
-                i += nb_chars;
-            }
-            else
-            {
-                tmp_jd = parse_dict(f, &i, err);
-            }
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return false;
+    }
 
-            *err |= ja->addValue(new DictValue(tmp_jd));
-            ++nb_elts_parsed;
+    uint_fast64_t nb_chars = S_ISREG(st.st_mode) ? st.st_size : 0;
+#ifndef DISABLE_MMAP
+    // Empty files can't be mapped
+    if (nb_chars > 0)
+    {
+        bool mapped = false;
+        bool ok = parse_mmap(fd, nb_chars, &mapped, h, doc, lazy, err);
+        if (mapped)
+        {
+            close(fd);
+            return ok;
         }
+    }
+#endif
 
-        if (*err)
+    FILE *f = fdopen(fd, "r");
+    if (f == nullptr)
+    {
+        close(fd);
+        return false;
+    }
+
+    bool ok = parse_file(f, nb_chars, h, doc, lazy, err);
+    fclose(f);
+    return ok;
+}
+
+/**
+** \brief Parses the given file in a new document. The nodes and strings are
+**        allocated in the arena of the document if 'use_arena' is true, on
+**        the heap otherwise
+*/
+Document *parse_document(char *file, bool use_arena, bool lazy)
+{
+    STATS_ALLOC(sizeof(Document));
+    if (use_arena)
+    {
+        STATS_ALLOC(sizeof(Arena));
+    }
+    Document *doc = new Document(use_arena ? new Arena() : nullptr);
+    doc->setKeys(NEW_KEY_TABLE(doc->getArena()));
+    uint_fast16_t err = 0;
+    JSON *j = nullptr;
+    {
+        DOMBuilder builder(doc->getArena(), &err, doc->getKeys());
+        if (parse_path(file, &builder, doc, lazy, &err))
         {
-            break;
+            j = builder.getRoot();
         }
     }
-    if (*err)
+
+    if (j == nullptr)
     {
-        print_err_bits(*err);
-        delete ja;
+        delete doc;
         return nullptr;
     }
-    *pos = i - 1;
-    return ja;
+    doc->setRoot(j);
+    return doc;
 }
 
+/*******************************************************************************
+**                              PARALLEL PARSING                              **
+*******************************************************************************/
 /**
-** \param f The file stream
-** \param pos A pointer to the position in the file of the character after the
-**            '{' that begins the current dict
-** \returns The json dict parsed from the position
+** \class Part Elements of a large array that are parsed by one of the workers
+**             of parse_array_parallel()
+** \param chars The characters of the elements, between two top-level commas
+**              of the array (or its brackets)
+** \param len The number of characters
+** \param arena The arena in which the elements are allocated, nullptr if they
+**              are allocated on the heap
+** \param builder The DOMBuilder that holds the elements until they are moved
+**                into the array
+** \param err The error bits of the parsing of the part
+** \param ok Whether the part was read entirely
 */
-JSONDict *parse_dict(FILE *f, uint_fast64_t *pos, uint_fast16_t *err)
+class Part
 {
-    if (f == nullptr || pos == nullptr || err == nullptr)
+public:
+    const char *chars;
+    uint_fast64_t len;
+    Arena *arena;
+    DOMBuilder *builder;
+    uint_fast16_t err;
+    bool ok;
+};
+
+/**
+** \class PartQueue Parts of an array, that are given to the workers as soon
+**                  as split_array() finds them
+** \param parts The parts, allocated for the maximum number of parts
+** \param nb_parts The number of parts found so far
+** \param next The position of the next part that a worker will take
+** \param done Whether all the parts were found
+** \param retained Whether the strings can point into the input
+** \param use_arena Whether the elements are allocated in an arena (one per
+**                  part, to be adopted by the arena of the document)
+*/
+class PartQueue
+{
+public:
+    Part *parts;
+    uint_fast64_t nb_parts;
+    uint_fast64_t next;
+    bool done;
+    bool retained;
+    bool use_arena;
+    std::mutex mutex;
+    std::condition_variable cond;
+
+    PartQueue(uint_fast64_t max_parts, bool retained, bool use_arena)
+        : parts(new Part[max_parts])
+        , nb_parts(0)
+        , next(0)
+        , done(false)
+        , retained(retained)
+        , use_arena(use_arena)
+    {}
+
+    ~PartQueue()
     {
-        return nullptr;
+        delete[] parts;
     }
 
-    uint_fast64_t i = *pos;
+    /**
+    ** \brief Adds the part of the 'len' characters at 'chars'
+    */
+    void push(const char *chars, uint_fast64_t len)
+    {
+        Part *p = parts + nb_parts;
+        p->chars = chars;
+        p->len = len;
+        p->arena = nullptr;
+        p->builder = nullptr;
+        p->err = 0;
+        p->ok = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++nb_parts;
+        }
+        cond.notify_one();
+    }
 
-    uint_fast64_t nb_elts_parsed = 0;
-    uint_fast64_t nb_elts = get_nb_elts_dict(f, i, err);
-    if (*err)
+    void close()
     {
-        return nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done = true;
+        }
+        cond.notify_all();
     }
 
-    JSONDict *jd = new JSONDict();
-    if (nb_elts == 0)
+    /**
+    ** \returns The next part to parse, waiting until it is found, or nullptr
+    **          if there are no parts left
+    */
+    Part *pop()
     {
-        ++(*pos);
-        return jd;
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait(lock, [this] { return next < nb_parts || done; });
+        return next < nb_parts ? parts + next++ : nullptr;
     }
+};
 
-    String *key = nullptr;
-    char c = 0;
-    char is_waiting_key = 1;
-    // We start at 1 because if we entered this function, it means that we
-    // already read a '['
-    while (SEEK_AND_GET_CHAR(i) && nb_elts_parsed < nb_elts && c != 0)
+/**
+** \brief Cuts the array of the input in parts of at least PARALLEL_CHUNK_SIZE
+**        characters, at some of its top-level commas, in a single pass over
+**        its structural characters (over the characters, skipping the strings,
+**        if the input is not indexed). Each part is given to the workers as
+**        soon as its end is found
+** \returns false if the input is not an array (in which case no part is
+**          given to the workers), or if the array is not closed
+*/
+bool split_array(const char *chars, uint_fast64_t len, PartQueue *q)
+{
+    Reader r(chars, len);
+    if (r.index != nullptr)
+    {
+        r.advance();
+    }
+    while (r.pos < r.len && IS_WHITESPACE(r.data[r.pos]))
     {
-        if (c == '"')
+        ++r.pos;
+    }
+    if (r.pos >= r.len || r.data[r.pos] != '[')
+    {
+        return false;
+    }
+
+    uint_fast64_t last = r.pos;
+    uint_fast64_t depth = 0;
+    for (; r.pos < r.len; r.advance())
+    {
+        char c = r.data[r.pos];
+        if (c == '"' && r.index == nullptr)
         {
-            if (is_waiting_key)
+            // Moves to the '"' that ends the string
+            while (++r.pos < r.len && r.data[r.pos] != '"')
             {
-                key = parse_string(f, &i);
-                is_waiting_key = 0;
-            }
-            else
-            {
-                *err |= jd->addItem(new StringItem(key, parse_string(f, &i)));
-                ++nb_elts_parsed;
+                r.pos += r.data[r.pos] == '\\';
             }
         }
-        else if (IS_NUMBER_START(c))
+        else if (c == '[' || c == '{')
         {
-            StrAndLenTuple sl = parse_number(f, &i);
-            if (sl.str == nullptr)
-            {
-                continue;
-            }
-
-            if (sl.is_float)
-            {
-                *err |= jd->addItem(new DoubleItem(key, str_to_double(&sl)));
-            }
-            else
-            {
-                *err |= jd->addItem(new IntItem(key, str_to_long(&sl)));
-            }
-            ++nb_elts_parsed;
+            ++depth;
         }
-        else if (IS_BOOL_START(c))
+        else if ((c == ']' || c == '}') && --depth == 0)
         {
-            uint_fast64_t len = parse_boolean(f, &i);
-            if (IS_NOT_BOOLEAN(c, len))
-            {
-                continue;
-            }
-            *err |= jd->addItem(new BoolItem(key, len == 4 ? true : false));
-            ++nb_elts_parsed;
+            q->push(chars + last + 1, r.pos - last - 1);
+            // The parts can't detect a '}' that closes the array, nor the
+            // characters after it
+            return c == ']' && is_input_end(&r);
         }
-        else if (c == 'n')
+        else if (c == ',' && depth == 1 && r.pos - last > PARALLEL_CHUNK_SIZE)
         {
-            *err |= jd->addItem(new NullItem(key));
-            i += 3;
-            ++nb_elts_parsed;
+            q->push(chars + last + 1, r.pos - last - 1);
+            last = r.pos;
         }
-        else if (c == '[')
-        {
-            uint_fast64_t nb_chars = get_nb_chars_in_array(f, i, err);
-            if (*err)
-            {
-                break;
-            }
+    }
+    return false;
+}
 
-            JSONArray *tmp_ja = nullptr;
-            // If there is enough space, we fill a buffer to read from it
-            if (nb_chars < MAX_READ_BUFF_SIZE)
-            {
-                char *b = new char[nb_chars + 1]();
-                if (fseek(f, i, SEEK_SET) != 0)
-                {
-                    *err = ERR_FSEEK;
-                    delete[] b;
-                    break;
-                }
-                fread(b, sizeof(char), nb_chars, f);
-                tmp_ja = parse_array_buff(b, nullptr, err);
-                delete[] b;
-                i += nb_chars;
-            }
-            else
-            {
-                tmp_ja = parse_array(f, &i, err);
-            }
+/**
+** \brief Loop of the workers of parse_array_parallel() : takes the next part
+**        that is not parsed yet, until there are none left. As the parts are
+**        taken one at a time, the workers that get small parts take more of
+**        them
+*/
+void parse_parts(PartQueue *q)
+{
+    Part *p = nullptr;
+    while ((p = q->pop()) != nullptr)
+    {
+        p->arena =
+            q->use_arena ? new Arena(BUFF_ARENA_BLOCK_SIZE(p->len)) : nullptr;
+        p->builder = new DOMBuilder(p->arena, &p->err);
+        p->builder->startElements();
 
-            *err |= jd->addItem(new ArrayItem(key, tmp_ja));
-            ++nb_elts_parsed;
-        }
-        else if (c == '{')
+        Reader r(p->chars, p->len);
+        r.retained = q->retained;
+        p->ok = parse_elements(&r, p->builder, &p->err);
+    }
+}
+
+/**
+** \brief Frees the parts, and the elements that were not moved out of them. If
+**        'arena' is not nullptr, it adopts the arenas of the parts instead of
+**        freeing them
+*/
+void free_parts(PartQueue *q, Arena *arena)
+{
+    for (uint_fast64_t k = 0; k < q->nb_parts; ++k)
+    {
+        delete q->parts[k].builder;
+        if (arena != nullptr)
         {
-            uint_fast64_t nb_chars = get_nb_chars_in_dict(f, i, err);
-            if (*err)
-            {
-                break;
-            }
+            arena->adopt(q->parts[k].arena);
+        }
+        delete q->parts[k].arena;
+    }
+}
 
-            JSONDict *tmp_jd = nullptr;
-            // If there is enough space, we fill a buffer to read from it
-            if (nb_chars < MAX_READ_BUFF_SIZE)
-            {
-                char *b = new char[nb_chars + 1]();
-                if (fseek(f, i, SEEK_SET) != 0)
-                {
-                    *err = ERR_FSEEK;
-                    delete[] b;
-                    break;
-                }
-                fread(b, sizeof(char), nb_chars, f);
-                tmp_jd = parse_dict_buff(b, nullptr, err);
-                delete[] b;
-                i += nb_chars;
-            }
-            else
-            {
-                tmp_jd = parse_dict(f, &i, err);
-            }
+/**
+** \brief Moves the elements of the parts into a new array, in order, and frees
+**        the parts
+** \returns The array, or nullptr if one of the parts is invalid
+*/
+JSONArray *merge_parts(PartQueue *q, Arena *arena)
+{
+    bool ok = true;
+    uint_fast64_t nb_elements = 0;
+    for (uint_fast64_t k = 0; k < q->nb_parts; ++k)
+    {
+        uint_fast64_t n = q->parts[k].builder->getNbElements();
+        // Only the part of an empty array has no elements, the other ones are
+        // between two commas (or a comma and a bracket)
+        ok = ok && q->parts[k].ok && (n > 0 || q->nb_parts == 1);
+        nb_elements += n;
+    }
 
-            *err |= jd->addItem(new DictItem(key, tmp_jd));
-            ++nb_elts_parsed;
-        }
-        else if (c == ',')
+    JSONArray *ja = nullptr;
+    if (ok)
+    {
+        ja = arena_new<JSONArray>(arena, arena);
+        ja->reserve(nb_elements);
+        for (uint_fast64_t k = 0; k < q->nb_parts && ok; ++k)
         {
-            is_waiting_key = 1;
+            ok = q->parts[k].builder->takeElements(ja) == 0;
         }
+    }
 
-        if (*err)
+    free_parts(q, ok ? arena : nullptr);
+    if (!ok && arena == nullptr)
+    {
+        // The array of an arena is freed with it
+        delete ja;
+    }
+    return ok ? ja : nullptr;
+}
+
+/**
+** \brief Parses the array of the input in parallel : this thread cuts it in
+**        parts (see split_array()) while 'nb_workers' - 1 threads parse them,
+**        then it helps them, and the elements of the parts are moved into the
+**        array in order.
+**        If the input is a dict or if there is a single worker, it is parsed
+**        by this thread only
+** \param arena The arena in which the json object is allocated, or nullptr
+** \param retained Whether the strings can point into the input
+** \returns The json object, or nullptr if the input is not a valid json array
+**          or dict
+*/
+JSON *parse_array_parallel(const char *chars, uint_fast64_t len, Arena *arena,
+                           bool retained, uint_fast32_t nb_workers)
+{
+    // The parts are longer than PARALLEL_CHUNK_SIZE, except the last one
+    PartQueue q(nb_workers > 1 ? len / PARALLEL_CHUNK_SIZE + 1 : 0, retained,
+                arena != nullptr);
+    bool is_array = false;
+    if (nb_workers > 1)
+    {
+        std::thread *threads = new std::thread[nb_workers - 1];
+        for (uint_fast32_t i = 0; i < nb_workers - 1; ++i)
         {
-            break;
+            threads[i] = std::thread(parse_parts, &q);
         }
+        is_array = split_array(chars, len, &q);
+        q.close();
+        parse_parts(&q);
+        for (uint_fast32_t i = 0; i < nb_workers - 1; ++i)
+        {
+            threads[i].join();
+        }
+        delete[] threads;
+    }
+
+    if (is_array)
+    {
+        return merge_parts(&q, arena);
+    }
+    if (q.nb_parts > 0)
+    {
+        // The array is not closed
+        free_parts(&q, nullptr);
+        return nullptr;
+    }
+
+    Reader r(chars, len);
+    r.retained = retained;
+    uint_fast16_t err = 0;
+    DOMBuilder builder(arena, &err);
+    return parse_root(&r, &builder, &err) ? builder.getRoot() : nullptr;
+}
+
+/**
+** \brief Maps the given regular file in memory (or reads it in a buffer)
+** \param size Set to the size of the input
+** \param mapped Set to whether the input is mapped or allocated with new[]
+** \returns The input, or nullptr if the file can't be stored entirely in
+**          memory (empty, too large, or not a regular file)
+*/
+const char *read_input(char *file, uint_fast64_t *size, bool *mapped)
+{
+    int fd = open(file, O_RDONLY);
+    if (fd == -1)
+    {
+        return nullptr;
     }
-    if (*err)
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0)
     {
-        print_err_bits(*err);
-        if (*err != ERR_NULL_KEY)
+        close(fd);
+        return nullptr;
+    }
+    *size = st.st_size;
+
+#ifndef DISABLE_MMAP
+    void *map = mmap(nullptr, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map != MAP_FAILED)
+    {
+        // The parts are read at the same time, only a hint to the kernel
+        madvise(map, *size, MADV_WILLNEED);
+        close(fd);
+        *mapped = true;
+        return (const char *)map;
+    }
+#endif
+
+    char *b = nullptr;
+    if (*size < MAX_READ_BUFF_SIZE)
+    {
+        b = new char[*size];
+        FILE *f = fdopen(fd, "r");
+        if (f == nullptr)
         {
-            delete key;
+            close(fd);
+            delete[] b;
+            return nullptr;
         }
-        delete jd;
-        return nullptr;
+        *size = fread(b, sizeof(char), *size, f);
+        fclose(f);
     }
-    *pos = i - 1;
-    return jd;
+    else
+    {
+        close(fd);
+    }
+    *mapped = false;
+    return b;
 }
 
 /*******************************************************************************
@@ -1612,72 +1637,360 @@ JSONDict *parse_dict(FILE *f, uint_fast64_t *pos, uint_fast16_t *err)
 *******************************************************************************/
 JSON *parse(char *file)
 {
-    FILE *f = fopen(file, "r");
-    if (f == nullptr)
+    uint_fast16_t err = 0;
+    DOMBuilder builder(nullptr, &err);
+    return parse_path(file, &builder, (Document *)nullptr, false, &err)
+        ? builder.getRoot()
+        : nullptr;
+}
+
+Document *parse(char *file, bool use_arena)
+{
+    return parse_document(file, use_arena, false);
+}
+
+Document *parse(char *file, bool use_arena, ParseStats *stats)
+{
+    if (stats != nullptr)
     {
-        return nullptr;
+        *stats = ParseStats();
     }
+#ifdef ENABLE_PARSE_STATS
+    ParseStats *prev = current_stats();
+    current_stats() = stats;
+    STATS_START(start);
+#endif
 
-    uint_fast64_t offset = 0;
-    if (fseek(f, offset++, SEEK_SET) != 0)
+    Document *doc = parse_document(file, use_arena, false);
+
+#ifdef ENABLE_PARSE_STATS
+    STATS_STOP(total_ns, start);
+    if (stats != nullptr)
+    {
+        // The timers of the phases are nested in the parsing, whose remaining
+        // time is spent on the structure of the input and on the tree
+        uint_fast64_t phases = stats->io_ns + stats->index_ns
+            + stats->string_ns + stats->number_ns;
+        stats->build_ns =
+            stats->total_ns > phases ? stats->total_ns - phases : 0;
+    }
+    current_stats() = prev;
+#endif
+    return doc;
+}
+
+Document *parse_lazy(char *file, bool use_arena)
+{
+    return parse_document(file, use_arena, true);
+}
+
+JSON *parse_buffer(const char *chars, uint_fast64_t len)
+{
+    if (chars == nullptr)
     {
-        fclose(f);
         return nullptr;
     }
 
-    // Obtains the number of characters in the file
-    struct stat st;
-    stat(file, &st);
-    uint_fast64_t nb_chars = st.st_size;
+    uint_fast16_t err = 0;
+    Reader r(chars, len);
+    DOMBuilder builder(nullptr, &err);
+    return parse_root(&r, &builder, &err) ? builder.getRoot() : nullptr;
+}
 
+Document *parse_buffer(const char *chars, uint_fast64_t len, bool use_arena)
+{
+    if (chars == nullptr)
+    {
+        return nullptr;
+    }
+
+    Arena *arena = use_arena ? new Arena(BUFF_ARENA_BLOCK_SIZE(len)) : nullptr;
+    Document *doc = new Document(arena);
+    doc->setKeys(NEW_KEY_TABLE(arena));
     uint_fast16_t err = 0;
-    char c = fgetc(f);
-    if (c == '{')
+    JSON *j = nullptr;
     {
-        JSONDict *jd = nullptr;
-        if (nb_chars < MAX_READ_BUFF_SIZE)
-        {
-            char *b = new char[nb_chars + 1]();
-            if (fseek(f, offset, SEEK_SET) != 0)
-            {
-                fclose(f);
-                delete[] b;
-                return nullptr;
-            }
-            fread(b, sizeof(char), nb_chars, f);
-            jd = parse_dict_buff(b, nullptr, &err);
-            delete[] b;
-        }
-        else
+        Reader r(chars, len);
+        DOMBuilder builder(arena, &err, doc->getKeys());
+        if (parse_root(&r, &builder, &err))
         {
-            jd = parse_dict(f, &offset, &err);
+            j = builder.getRoot();
         }
-        fclose(f);
-        return jd;
     }
-    else if (c == '[')
+
+    if (j == nullptr)
+    {
+        delete doc;
+        return nullptr;
+    }
+    doc->setRoot(j);
+    return doc;
+}
+
+JSON *parse_span(const char *chars, uint_fast64_t len, Arena *arena)
+{
+    Reader r(chars, len);
+    r.retained = true;
+    r.lazy = true;
+    uint_fast16_t err = 0;
+    DOMBuilder builder(arena, &err);
+    return parse_root(&r, &builder, &err) ? builder.getRoot() : nullptr;
+}
+
+bool parse(char *file, Handler *handler, uint_fast16_t *err)
+{
+    uint_fast16_t e = 0;
+    bool ok = parse_path(file, handler, (Document *)nullptr, false, &e);
+    if (err != nullptr)
+    {
+        *err = e;
+    }
+    return ok;
+}
+
+bool parse_buffer(const char *chars, uint_fast64_t len, Handler *handler,
+                  uint_fast16_t *err)
+{
+    uint_fast16_t e = 0;
+    bool ok = false;
+    if (chars != nullptr)
+    {
+        Reader r(chars, len);
+        // The characters are alive during the whole parsing
+        r.retained = true;
+        ok = parse_root(&r, handler, &e);
+    }
+    if (err != nullptr)
+    {
+        *err = e;
+    }
+    return ok;
+}
+
+Tape *parse_tape(char *file)
+{
+    // The size of the file is only used to size the tape
+    struct stat st;
+    uint_fast64_t size = file != nullptr && stat(file, &st) == 0
+            && S_ISREG(st.st_mode)
+        ? st.st_size
+        : 0;
+
+    Tape *tape = new Tape(size);
+    uint_fast16_t err = 0;
+    TapeBuilder builder(tape);
+    if (!parse_path(file, &builder, (Document *)nullptr, false, &err))
+    {
+        delete tape;
+        return nullptr;
+    }
+    return tape;
+}
+
+Tape *parse_tape(const char *chars, uint_fast64_t len)
+{
+    if (chars == nullptr)
     {
-        JSONArray *ja = nullptr;
-        if (nb_chars < MAX_READ_BUFF_SIZE)
+        return nullptr;
+    }
+
+    Tape *tape = new Tape(len);
+    uint_fast16_t err = 0;
+    Reader r(chars, len);
+    TapeBuilder builder(tape);
+    if (!parse_root(&r, &builder, &err))
+    {
+        delete tape;
+        return nullptr;
+    }
+    return tape;
+}
+
+Document *parse_parallel(char *file, bool use_arena, uint_fast32_t nb_workers)
+{
+    uint_fast64_t size = 0;
+    bool mapped = false;
+    const char *chars = file == nullptr ? nullptr
+                                        : read_input(file, &size, &mapped);
+    if (chars == nullptr)
+    {
+        return file == nullptr ? nullptr : parse(file, use_arena);
+    }
+
+    if (nb_workers == 0)
+    {
+        nb_workers = std::thread::hardware_concurrency();
+    }
+    Document *doc = new Document(use_arena ? new Arena() : nullptr);
+    bool retained = RETAIN_INPUT(doc);
+    JSON *j = parse_array_parallel(chars, size, doc->getArena(), retained,
+                                   nb_workers == 0 ? 1 : nb_workers);
+    if (j != nullptr && retained)
+    {
+        doc->retainInput(chars, size, mapped);
+    }
+    else if (mapped)
+    {
+        munmap((void *)chars, size);
+    }
+    else
+    {
+        delete[] chars;
+    }
+
+    if (j == nullptr)
+    {
+        delete doc;
+        return nullptr;
+    }
+    doc->setRoot(j);
+    return doc;
+}
+
+/*******************************************************************************
+**                                   PARSER                                   **
+*******************************************************************************/
+Parser::Parser()
+    : keys(NEW_KEY_TABLE(&arena))
+    , builder(nullptr)
+    , buffers(new ParseBuffers())
+    , index(nullptr)
+    , input(nullptr)
+    , input_size(0)
+    , err(0)
+{
+    builder = new DOMBuilder(&arena, &err, keys);
+}
+
+Parser::~Parser()
+{
+    delete builder;
+    delete buffers;
+    delete index;
+    delete[] input;
+}
+
+/**
+** \brief Makes sure that 'n' characters fit in the read buffer. If it grows,
+**        only its first 'keep' characters are copied in the new one (the
+**        characters that were read from the current file), the others are
+**        left over from the previous files
+*/
+void Parser::reserveInput(uint_fast64_t n, uint_fast64_t keep)
+{
+    if (n <= input_size)
+    {
+        return;
+    }
+
+    uint_fast64_t size = input_size * 2 > n ? input_size * 2 : n;
+    STATS_ALLOC(size);
+    char *tmp = new char[size];
+    if (keep > 0)
+    {
+        std::memcpy(tmp, input, keep);
+    }
+    delete[] input;
+    input = tmp;
+    input_size = size;
+}
+
+/**
+** \brief Parses the given characters with the arena, stacks and index of the
+**        parser, after freeing the previous json object
+** \param retained Whether the characters stay alive as long as the json
+**                 object, so its strings can point into them
+*/
+JSON *Parser::parseChars(const char *chars, uint_fast64_t len, bool retained)
+{
+    arena.reset();
+    // The table was in the arena
+    keys = NEW_KEY_TABLE(&arena);
+    builder->reset(keys);
+    err = 0;
+#ifndef DISABLE_STRUCTURAL_INDEX
+    if (index == nullptr)
+    {
+        index = new StructuralIndex(chars, len);
+    }
+#endif
+
+    Reader r(chars, len, index);
+    r.retained = retained;
+    return parse_root(&r, builder, &err, buffers) ? builder->getRoot()
+                                                   : nullptr;
+}
+
+/**
+** \brief Reads the given file in the buffer of the parser and parses it (see
+**        Parser)
+** \returns The json object, valid until the next call to parse(), or nullptr
+**          if the file could not be read or is not a valid json array or dict
+*/
+JSON *Parser::parse(char *file)
+{
+    int fd = file == nullptr ? -1 : open(file, O_RDONLY);
+    if (fd == -1)
+    {
+        return nullptr;
+    }
+
+    // One more character, so that the read that finds the end of the file
+    // does not grow the buffer
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
+    {
+        reserveInput(st.st_size + 1, 0);
+    }
+
+    uint_fast64_t size = 0;
+    while (1)
+    {
+        // Only the streams grow the buffer while it is read
+        reserveInput(size + 1, size);
+        ssize_t nb_read = read(fd, input + size, input_size - size);
+        if (nb_read <= 0)
         {
-            char *b = new char[nb_chars + 1]();
-            if (fseek(f, offset, SEEK_SET) != 0)
+            close(fd);
+            if (nb_read < 0)
             {
-                fclose(f);
-                delete[] b;
                 return nullptr;
             }
-            fread(b, sizeof(char), nb_chars, f);
-            ja = parse_array_buff(b, nullptr, &err);
-            delete[] b;
-        }
-        else
-        {
-            ja = parse_array(f, &offset, &err);
+            break;
         }
-        fclose(f);
-        return ja;
+        size += nb_read;
     }
-    fclose(f);
-    return nullptr;
+    STATS_ADD(bytes_read, size);
+
+    // The buffer is kept until the next call, as long as the json object
+    return parseChars(input, size, USE_STRING_VIEWS);
+}
+
+/**
+** \brief Parses the 'len' characters at 'chars' (see Parser). The strings are
+**        copied in the arena of the parser, so the characters can be freed as
+**        soon as this returns
+** \returns The json object, valid until the next call to parse(), or nullptr
+**          if the characters are not a valid json array or dict
+*/
+JSON *Parser::parse(const char *chars, uint_fast64_t len)
+{
+    return chars == nullptr ? nullptr : parseChars(chars, len, false);
+}
+
+/**
+** \returns The table of the keys of the last json object (see
+**          Document::getKeys()), valid until the next call to parse()
+*/
+KeyTable *Parser::getKeys()
+{
+    return keys;
+}
+
+/**
+** \returns The error bits of the last parsing (see ERR_* in json_types.hpp)
+*/
+uint_fast16_t Parser::getErr()
+{
+    return err;
 }
@@ -4,7 +4,70 @@
 /*******************************************************************************
 **                                  INCLUDES                                  **
 *******************************************************************************/
+#if __cplusplus >= 201703L
+#    include <string_view>
+#endif
+
+#include "handler.hpp"
 #include "json.hpp"
+#include "stats.hpp"
+#include "tape.hpp"
+
+/*******************************************************************************
+**                                   CLASSES                                  **
+*******************************************************************************/
+class DOMBuilder;
+class KeyTable;
+class ParseBuffers;
+class StructuralIndex;
+
+/**
+** \class Parser Parser that is reused for many documents
+** \brief Each parse() allocates its own arena, stacks, index and read buffer,
+**        and frees them all with the document. A Parser keeps them from one
+**        parsing to the next instead : its arena is reset (its blocks are
+**        kept), and the buffers are only grown when a larger document needs
+**        it. Once it has parsed a document as large as the next ones, parsing
+**        them does not allocate anything.
+**        The json object returned by parse() is allocated in the arena of the
+**        parser, so it is only valid until the next call to parse() or the
+**        destruction of the parser, and must not be deleted
+** \param arena The arena in which the json objects are allocated
+** \param keys The table in which the keys of the json object are interned,
+**             allocated in the arena (nullptr if DISABLE_KEY_INTERNING is
+**             defined)
+** \param builder The builder of the json objects, whose stacks are reused
+** \param buffers The buffers of the containers and of the escaped strings
+** \param index The structural index, reset on each input (nullptr until the
+**              first one, or if DISABLE_STRUCTURAL_INDEX is defined)
+** \param input The buffer in which the files are read
+** \param input_size The number of characters that fit in 'input'
+** \param err The error bits of the last parsing
+*/
+class Parser
+{
+private:
+    Arena arena;
+    KeyTable *keys;
+    DOMBuilder *builder;
+    ParseBuffers *buffers;
+    StructuralIndex *index;
+    char *input;
+    uint_fast64_t input_size;
+    uint_fast16_t err;
+
+    void reserveInput(uint_fast64_t n, uint_fast64_t keep);
+    JSON *parseChars(const char *chars, uint_fast64_t len, bool retained);
+
+public:
+    Parser();
+    ~Parser();
+
+    JSON *parse(char *file);
+    JSON *parse(const char *chars, uint_fast64_t len);
+    KeyTable *getKeys();
+    uint_fast16_t getErr();
+};
 
 /*******************************************************************************
 **                                 FUNCTIONS                                  **
@@ -14,4 +77,143 @@
 */
 JSON *parse(char *file);
 
+/**
+** \brief Parse the given file and returns a document handle on the associated
+**        JSON object.
+**        If 'use_arena' is true, all the nodes and strings of the object are
+**        allocated in an arena owned by the document, which makes their
+**        allocation and their destruction (deleting the document) much
+**        cheaper. The object must then only be freed by deleting the document
+*/
+Document *parse(char *file, bool use_arena);
+
+/**
+** \brief Same as parse(file, use_arena), and fills the given statistics of
+**        the parsing (see ParseStats). They are only collected if the parser
+**        is compiled with ENABLE_PARSE_STATS, they are all 0 otherwise
+*/
+Document *parse(char *file, bool use_arena, ParseStats *stats);
+
+/**
+** \brief Parses the given file in a tape (see Tape) instead of a tree of
+**        JSONArray and JSONDict. The strings are copied in the tape, which
+**        doesn't need the file once it is parsed
+** \returns The tape, which the caller has to delete, or nullptr if the file
+**          is not a valid json array or dict
+*/
+Tape *parse_tape(char *file);
+
+/**
+** \brief Parses the json array or dict of the 'len' characters at 'chars' in
+**        a tape (see parse_tape(file))
+*/
+Tape *parse_tape(const char *chars, uint_fast64_t len);
+
+/**
+** \brief Same as parse(file, use_arena), except that if the root of the file
+**        is a large array, it is parsed by several threads : a first pass
+**        over its structural characters cuts it in parts of about
+**        PARALLEL_CHUNK_SIZE characters (at top-level commas), the parts are
+**        parsed by 'nb_workers' threads, and their elements are moved into a
+**        single JSONArray, in order.
+**        The streams that are not regular files are parsed by parse()
+** \param nb_workers The number of threads, 0 to use one per core
+*/
+Document *parse_parallel(char *file, bool use_arena,
+                         uint_fast32_t nb_workers = 0);
+
+/**
+** \brief Same as parse(file, use_arena), except that only the top-level
+**        container is parsed : its nested arrays and dicts are only delimited
+**        (by matching their brackets) and are parsed the first time they are
+**        accessed through Value::getArray() or Value::getDict() (see
+**        LazyJSON). Reading a few fields of a large document then only costs
+**        the parsing of the containers that lead to them.
+**        The nested containers are checked when they are parsed, a lazy
+**        container whose content is invalid is accessed as nullptr.
+**        The streams that are not regular files are parsed entirely
+*/
+Document *parse_lazy(char *file, bool use_arena);
+
+/**
+** \brief Parses the json array or dict of the 'len' characters at 'chars',
+**        which are read in place (they don't have to be null terminated), and
+**        returns the associated JSON object. The strings are copied, so the
+**        characters can be freed as soon as this returns.
+**        The buffer functions are not overloads of parse(file, ...), so that a
+**        length of any integer type can't select one that takes a file path
+** \returns The json object, or nullptr if the characters are not a valid
+**          json array or dict
+*/
+JSON *parse_buffer(const char *chars, uint_fast64_t len);
+
+/**
+** \brief Parses the json array or dict of the 'len' characters at 'chars' in
+**        a new document (see parse(file, use_arena)). The strings are copied,
+**        so the characters can be freed as soon as this returns.
+**        The blocks of the arena are sized from 'len', so parsing many small
+**        documents does not allocate ARENA_BLOCK_SIZE bytes for each of them
+** \returns The document, or nullptr if the characters are not a valid json
+**          array or dict
+*/
+Document *parse_buffer(const char *chars, uint_fast64_t len, bool use_arena);
+
+/**
+** \brief Parses the array or dict of 'len' characters at 'chars' lazily (see
+**        parse_lazy()). Used by LazyJSON, the characters must stay alive as
+**        long as the returned object
+** \param arena The arena in which the object is allocated, or nullptr
+*/
+JSON *parse_span(const char *chars, uint_fast64_t len, Arena *arena);
+
+/**
+** \brief Reads the given file and calls the handler for each of its tokens
+**        (see Handler) instead of building a json object, so the memory used
+**        does not depend on the size of the json object. The file is read
+**        from a mapping (or a buffer if it can't be mapped), the streams
+**        that are not regular files through a fixed-size window
+** \param err If not nullptr, receives the error bits of the parsing, in which
+**            ERR_HANDLER_STOPPED tells that the handler stopped it
+** \returns false if the file is not a valid json array or dict, or if the
+**          handler stopped the parsing
+*/
+bool parse(char *file, Handler *handler, uint_fast16_t *err = nullptr);
+
+/**
+** \brief Calls the handler for each of the tokens of the 'len' characters at
+**        'chars' (see parse(file, handler, err)). The strings given to the
+**        handler point into the characters when they have no escape sequences
+*/
+bool parse_buffer(const char *chars, uint_fast64_t len, Handler *handler,
+                  uint_fast16_t *err = nullptr);
+
+#if __cplusplus >= 201703L
+/**
+** \brief Same as parse_buffer(chars, len), from the characters of the view
+*/
+inline JSON *parse_buffer(std::string_view json)
+{
+    return parse_buffer(json.data(), json.size());
+}
+
+/**
+** \brief Same as parse_buffer(chars, len, use_arena), from the characters of
+**        the view
+*/
+inline Document *parse_buffer(std::string_view json, bool use_arena)
+{
+    return parse_buffer(json.data(), json.size(), use_arena);
+}
+
+/**
+** \brief Same as parse_buffer(chars, len, handler, err), from the characters
+**        of the view
+*/
+inline bool parse_buffer(std::string_view json, Handler *handler,
+                         uint_fast16_t *err = nullptr)
+{
+    return parse_buffer(json.data(), json.size(), handler, err);
+}
+#endif // __cplusplus >= 201703L
+
 #endif // !JSON_PARSER_H
@@ -0,0 +1,177 @@
+#include "path.hpp"
+
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <cstring>
+
+/*******************************************************************************
+**                              DEFINES / MACROS                              **
+*******************************************************************************/
+// Maximum number of digits of a position, so that it fits in an int64_t
+#define MAX_INDEX_DIGITS 18
+
+/*******************************************************************************
+**                              LOCAL FUNCTIONS                               **
+*******************************************************************************/
+/**
+** \returns The position written in the 'len' characters at 'key', or -1 if
+**          they are not a position (only digits, without leading zeros)
+*/
+static int_fast64_t parse_index(const char *key, uint_strlen_t len)
+{
+    if (len == 0 || len > MAX_INDEX_DIGITS || (key[0] == '0' && len > 1))
+    {
+        return -1;
+    }
+
+    int_fast64_t index = 0;
+    for (uint_strlen_t i = 0; i < len; ++i)
+    {
+        if (key[i] < '0' || key[i] > '9')
+        {
+            return -1;
+        }
+        index = index * 10 + (key[i] - '0');
+    }
+    return index;
+}
+
+/*******************************************************************************
+**                                    PATH                                    **
+*******************************************************************************/
+/**
+** \brief Compiles the given path, which is a JSON Pointer if it starts with a
+**        '/', a dotted path otherwise
+*/
+Path::Path(const char *path)
+    : keys(nullptr)
+    , steps(nullptr)
+    , nb_steps(0)
+    , valid(path != nullptr)
+{
+    if (path == nullptr || path[0] == '\0')
+    {
+        return;
+    }
+
+    bool is_pointer = path[0] == '/';
+    char separator = is_pointer ? '/' : '.';
+    const char *start = is_pointer ? path + 1 : path;
+    const char *end = start + strlen(start);
+
+    nb_steps = 1;
+    for (const char *c = start; c < end; ++c)
+    {
+        nb_steps += *c == separator;
+    }
+    // The decoded keys are never longer than the path
+    keys = new char[end - start + 1];
+    steps = new Step[nb_steps];
+
+    char *dst = keys;
+    for (uint_fast64_t i = 0; i < nb_steps; ++i)
+    {
+        const char *next = (const char *)memchr(start, separator, end - start);
+        if (next == nullptr)
+        {
+            next = end;
+        }
+
+        Step *step = steps + i;
+        step->key = dst;
+        for (const char *c = start; c < next; ++c)
+        {
+            if (!is_pointer || *c != '~')
+            {
+                *dst++ = *c;
+            }
+            else if (c + 1 < next && (c[1] == '0' || c[1] == '1'))
+            {
+                *dst++ = *++c == '0' ? '~' : '/';
+            }
+            else
+            {
+                valid = false;
+            }
+        }
+        step->len = dst - step->key;
+        step->hash = hash_str(step->key, step->len);
+        step->index = parse_index(step->key, step->len);
+        start = next + 1;
+    }
+}
+
+Path::~Path()
+{
+    delete[] keys;
+    delete[] steps;
+}
+
+bool Path::isValid()
+{
+    return valid;
+}
+
+uint_fast64_t Path::getNbSteps()
+{
+    return nb_steps;
+}
+
+/**
+** \brief Searches the value designated by the path in the given json object,
+**        in a single walk from the object to the value
+** \param result Receives the value if it is found (the json object itself as
+**               an array or dict value for the empty path)
+** \returns Whether the value was found
+*/
+bool Path::resolve(JSON *root, Value *result)
+{
+    if (!valid || root == nullptr || result == nullptr)
+    {
+        return false;
+    }
+
+    Value v = root->isArray() ? Value::fromArray((JSONArray *)root)
+                              : Value::fromDict((JSONDict *)root);
+    for (uint_fast64_t i = 0; i < nb_steps; ++i)
+    {
+        Step *step = steps + i;
+        switch (v.getType())
+        {
+        case T_ARR:
+        {
+            JSONArray *ja = v.getArray();
+            if (step->index < 0 || (uint_fast64_t)step->index >= ja->getSize())
+            {
+                return false;
+            }
+            v = *ja->getValueAt(step->index);
+            break;
+        }
+        case T_DICT:
+        {
+            Item *it = v.getDict()->getItem(step->key, step->len, step->hash);
+            if (it == nullptr)
+            {
+                return false;
+            }
+            v = *it->getValue();
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    *result = v;
+    return true;
+}
+
+/*******************************************************************************
+**                                 FUNCTIONS                                  **
+*******************************************************************************/
+bool query(JSON *root, const char *path, Value *result)
+{
+    Path p(path);
+    return p.resolve(root, result);
+}
@@ -0,0 +1,75 @@
+#ifndef PATH_HPP
+#define PATH_HPP
+
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <stdint.h>
+
+#include "json.hpp"
+
+/*******************************************************************************
+**                                   CLASSES                                  **
+*******************************************************************************/
+/**
+** \class Path Compiled path to a value of a json object
+** \brief The path is either a JSON Pointer (RFC 6901, "/a/b/3/c", where '~1'
+**        and '~0' stand for '/' and '~' in the keys), or a dotted path
+**        ("a.b.3.c"). The empty path designates the json object itself.
+**        Compiling the path once splits and decodes its keys and hashes them,
+**        so that resolving it in many documents only walks the objects
+** \param keys The decoded keys of the steps, one after the other
+** \param steps The steps of the path
+** \param nb_steps The number of steps
+** \param valid Whether the path is well formed (a JSON Pointer can contain
+**              invalid '~' escapes)
+*/
+class Path
+{
+private:
+    /**
+    ** \class Step Key of a dict or position in an array
+    ** \param key The key, used if the step is done in a dict (not null
+    **            terminated)
+    ** \param len The number of characters of the key
+    ** \param hash The hash of the key (hash_str())
+    ** \param index The position, used if the step is done in an array (-1 if
+    **              the key is not a valid position)
+    */
+    class Step
+    {
+    public:
+        const char *key;
+        uint_strlen_t len;
+        uint_fast64_t hash;
+        int_fast64_t index;
+    };
+
+    char *keys;
+    Step *steps;
+    uint_fast64_t nb_steps;
+    bool valid;
+
+public:
+    Path(const char *path);
+    ~Path();
+
+    bool isValid();
+    uint_fast64_t getNbSteps();
+    bool resolve(JSON *root, Value *result);
+};
+
+/*******************************************************************************
+**                                 FUNCTIONS                                  **
+*******************************************************************************/
+/**
+** \brief Searches the value designated by 'path' (see the Path class) in the
+**        given json object. To repeat the same query on many objects, compile
+**        the path once with a Path object instead
+** \param result Receives the value if it is found (the json object itself as
+**               an array or dict value for the empty path)
+** \returns Whether the value was found
+*/
+bool query(JSON *root, const char *path, Value *result);
+
+#endif // !PATH_HPP
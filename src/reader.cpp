@@ -0,0 +1,122 @@
+#include "reader.hpp"
+
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <cstring>
+
+#include "stats.hpp"
+
+/*******************************************************************************
+**                                   READER                                   **
+*******************************************************************************/
+Reader::Reader(const char *buff, uint_fast64_t len)
+    : f(nullptr)
+    , window(nullptr)
+    , window_size(0)
+    , owns_index(true)
+#ifdef DISABLE_STRUCTURAL_INDEX
+    , index(nullptr)
+#else
+    , index(new StructuralIndex(buff, len))
+#endif
+    , data(buff)
+    , len(len)
+    , pos(0)
+    , retained(false)
+    , lazy(false)
+{}
+
+/**
+** \brief Reads the buffer with the given index, which is reset on it instead
+**        of allocating a new one (nullptr to read the buffer without index).
+**        The index still belongs to the caller
+*/
+Reader::Reader(const char *buff, uint_fast64_t len, StructuralIndex *reused)
+    : f(nullptr)
+    , window(nullptr)
+    , window_size(0)
+    , owns_index(false)
+    , index(nullptr)
+    , data(buff)
+    , len(len)
+    , pos(0)
+    , retained(false)
+    , lazy(false)
+{
+#ifdef DISABLE_STRUCTURAL_INDEX
+    (void)reused;
+#else
+    index = reused;
+    if (index != nullptr)
+    {
+        index->reset(buff, len);
+    }
+#endif
+}
+
+Reader::Reader(FILE *f)
+    : f(f)
+    , window(new char[READER_WINDOW_SIZE])
+    , window_size(READER_WINDOW_SIZE)
+    , owns_index(true)
+    , index(nullptr)
+    , data(window)
+    , len(0)
+    , pos(0)
+    , retained(false)
+    , lazy(false)
+{
+    STATS_ALLOC(READER_WINDOW_SIZE);
+}
+
+Reader::~Reader()
+{
+    delete[] window;
+    if (owns_index)
+    {
+        delete index;
+    }
+}
+
+/**
+** \brief Moves the characters starting at the cursor to the beginning of the
+**        window and fills the rest of it with the next characters of the file.
+**        The cursor is then at position 0
+** \returns false if no character could be read (end of the input, or the
+**          input is a buffer that is already entirely in memory)
+*/
+bool Reader::refill()
+{
+    if (f == nullptr)
+    {
+        return false;
+    }
+
+    uint_fast64_t nb_kept = len - pos;
+    // The current token takes the whole window
+    if (nb_kept == window_size)
+    {
+        STATS_ALLOC(window_size * 2);
+        char *tmp = new char[window_size * 2];
+        std::memcpy(tmp, window + pos, nb_kept);
+        delete[] window;
+        window = tmp;
+        data = window;
+        window_size *= 2;
+    }
+    else if (nb_kept > 0)
+    {
+        std::memmove(window, window + pos, nb_kept);
+    }
+    pos = 0;
+    len = nb_kept;
+
+    STATS_START(start);
+    size_t nb_read =
+        fread(window + len, sizeof(char), window_size - len, f);
+    STATS_STOP(io_ns, start);
+    STATS_ADD(bytes_read, nb_read);
+    len += nb_read;
+    return nb_read > 0;
+}
@@ -0,0 +1,106 @@
+#ifndef READER_HPP
+#define READER_HPP
+
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <stdint.h>
+#include <stdio.h>
+
+#include "indexer.hpp"
+
+/*******************************************************************************
+**                              DEFINES / MACROS                              **
+*******************************************************************************/
+#ifndef READER_WINDOW_SIZE
+#    define READER_WINDOW_SIZE (1 << 18) // 256 KiB
+#endif
+
+/*******************************************************************************
+**                                   CLASSES                                  **
+*******************************************************************************/
+/**
+** \class Reader Cursor over the characters of a json document
+** \brief The characters come either from a buffer that is entirely in memory
+**        (read buffer or mapped file), or from a file stream that is read
+**        through a window of READER_WINDOW_SIZE characters. When the cursor
+**        reaches the end of the window, the window is refilled and the
+**        characters starting at the cursor are moved to its beginning, so a
+**        token that starts at the cursor is always contiguous in memory.
+**        The window only grows if a single token is larger than it.
+**        The buffers that are entirely in memory are also indexed by a
+**        StructuralIndex (unless DISABLE_STRUCTURAL_INDEX is defined), which
+**        lets advance() jump directly to the next token
+** \param owns_index Whether the index is deleted with the reader (it is not
+**                   if it was given to the constructor, to be reused)
+** \param index The structural index of the buffer, nullptr if the characters
+**              are read from a file stream
+** \param data The characters currently available ('data[pos]' is the current
+**             character)
+** \param len The number of characters in 'data'
+** \param pos The position of the cursor in 'data'
+** \param retained Whether the buffer is kept alive after the parsing (by a
+**                 Document), in which case the parsed strings can point into
+**                 it. Always false for file streams
+** \param lazy Whether the nested containers are kept as LazyJSON instead of
+**             being parsed (only possible if the buffer is retained)
+*/
+class Reader
+{
+private:
+    FILE *f;
+    char *window;
+    uint_fast64_t window_size;
+    bool owns_index;
+
+public:
+    StructuralIndex *index;
+    const char *data;
+    uint_fast64_t len;
+    uint_fast64_t pos;
+    bool retained;
+    bool lazy;
+
+    Reader(const char *buff, uint_fast64_t len);
+    Reader(const char *buff, uint_fast64_t len, StructuralIndex *reused);
+    Reader(FILE *f);
+    ~Reader();
+
+    bool refill();
+
+    /**
+    ** \brief Makes sure that at least 'n' characters are available from the
+    **        cursor, refilling the window if needed
+    ** \returns false if the end of the input is reached before
+    */
+    bool ensure(uint_fast64_t n)
+    {
+        while (len - pos < n)
+        {
+            if (!refill())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+    ** \brief Moves the cursor to the next character that has to be read, which
+    **        is the next token if the buffer is indexed (the end of the buffer
+    **        if there are no more tokens), the next character otherwise
+    */
+    void advance()
+    {
+        if (index == nullptr)
+        {
+            ++pos;
+        }
+        else if (!index->next(&pos))
+        {
+            pos = len;
+        }
+    }
+};
+
+#endif // !READER_HPP
@@ -0,0 +1,372 @@
+#include "scanner.hpp"
+
+/*******************************************************************************
+**                              LOCAL FUNCTIONS                               **
+*******************************************************************************/
+/**
+** \returns The value of the 4 hexadecimal digits at 'str', or -1 if one of
+**          them is not an hexadecimal digit
+*/
+int_fast32_t parse_hex4(const char *str)
+{
+    int_fast32_t res = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        char c = str[i];
+        int_fast32_t digit = -1;
+        if ('0' <= c && c <= '9')
+        {
+            digit = c - '0';
+        }
+        else if ('a' <= c && c <= 'f')
+        {
+            digit = c - 'a' + 10;
+        }
+        else if ('A' <= c && c <= 'F')
+        {
+            digit = c - 'A' + 10;
+        }
+
+        if (digit < 0)
+        {
+            return -1;
+        }
+        res = res * 16 + digit;
+    }
+    return res;
+}
+
+/**
+** \brief Writes the UTF-8 encoding of the code point 'cp' at 'dst'
+** \returns The number of bytes written
+*/
+uint_fast8_t encode_utf8(uint_fast32_t cp, char *dst)
+{
+    if (cp < 0x80)
+    {
+        dst[0] = cp;
+        return 1;
+    }
+    if (cp < 0x800)
+    {
+        dst[0] = 0xC0 | (cp >> 6);
+        dst[1] = 0x80 | (cp & 0x3F);
+        return 2;
+    }
+    if (cp < 0x10000)
+    {
+        dst[0] = 0xE0 | (cp >> 12);
+        dst[1] = 0x80 | ((cp >> 6) & 0x3F);
+        dst[2] = 0x80 | (cp & 0x3F);
+        return 3;
+    }
+    dst[0] = 0xF0 | (cp >> 18);
+    dst[1] = 0x80 | ((cp >> 12) & 0x3F);
+    dst[2] = 0x80 | ((cp >> 6) & 0x3F);
+    dst[3] = 0x80 | (cp & 0x3F);
+    return 4;
+}
+
+/*******************************************************************************
+**                                 FUNCTIONS                                  **
+*******************************************************************************/
+/**
+** \brief Decodes the escape sequences of the 'len' characters of a json string
+**        at 'src' into 'dst', which is at least 'len' characters long (the
+**        decoded string is never longer than the escaped one).
+**        '\\uXXXX' sequences are encoded in UTF-8 (with the surrogate pairs
+**        combined, and the lone surrogates replaced by U+FFFD). The invalid
+**        escape sequences are kept as is
+** \returns The number of decoded characters
+*/
+uint_fast64_t unescape_string(const char *src, uint_fast64_t len, char *dst)
+{
+    uint_fast64_t n = 0;
+    uint_fast64_t i = 0;
+    while (i < len)
+    {
+        const char *bs = (const char *)std::memchr(src + i, '\\', len - i);
+        uint_fast64_t run = bs == nullptr ? len - i : bs - (src + i);
+        std::memcpy(dst + n, src + i, run);
+        n += run;
+        i += run;
+        if (i + 1 >= len)
+        {
+            // No more escape sequences, or a trailing backslash
+            if (i < len)
+            {
+                dst[n++] = src[i++];
+            }
+            break;
+        }
+
+        char c = src[i + 1];
+        i += 2;
+        switch (c)
+        {
+        case '"':
+        case '\\':
+        case '/':
+            dst[n++] = c;
+            break;
+        case 'b':
+            dst[n++] = '\b';
+            break;
+        case 'f':
+            dst[n++] = '\f';
+            break;
+        case 'n':
+            dst[n++] = '\n';
+            break;
+        case 'r':
+            dst[n++] = '\r';
+            break;
+        case 't':
+            dst[n++] = '\t';
+            break;
+        case 'u': {
+            int_fast32_t cp = i + 4 <= len ? parse_hex4(src + i) : -1;
+            if (cp < 0)
+            {
+                dst[n++] = '\\';
+                dst[n++] = 'u';
+                break;
+            }
+            i += 4;
+
+            if (0xD800 <= cp && cp < 0xDC00 && i + 6 <= len
+                && src[i] == '\\' && src[i + 1] == 'u')
+            {
+                int_fast32_t low = parse_hex4(src + i + 2);
+                if (0xDC00 <= low && low < 0xE000)
+                {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    i += 6;
+                }
+            }
+            if (0xD800 <= cp && cp < 0xE000)
+            {
+                cp = 0xFFFD;
+            }
+            // 6 escaped characters never give more than 3 bytes, and 12 never
+            // more than 4
+            n += encode_utf8(cp, dst + n);
+            break;
+        }
+        default:
+            dst[n++] = '\\';
+            dst[n++] = c;
+            break;
+        }
+    }
+    return n;
+}
+
+/**
+** \brief Reads the string that starts at the cursor of the reader (on the '"')
+** \param r The reader, whose cursor is left on the '"' that ends the string
+** \param scratch The buffer in which the string is decoded if it contains
+**                escape sequences
+** \param str Set to the characters of the string (with its escape sequences
+**            decoded), which point into the input of the reader if 'escaped'
+**            is false, into the scratch buffer otherwise
+** \param len Set to the number of characters of the string
+** \param escaped Set to whether the string contains escape sequences
+** \returns false if the input ended before the end of the string
+*/
+bool read_string(Reader *r, Scratch *scratch, const char **str,
+                 uint_fast64_t *len, bool *escaped)
+{
+    // Number of characters between the two '"'
+    uint_fast64_t n = 0;
+    *escaped = false;
+    // The closing '"' is the next token of the index
+    if (r->index != nullptr)
+    {
+        uint_fast64_t end = 0;
+        if (!r->index->next(&end))
+        {
+            return false;
+        }
+        n = end - r->pos - 1;
+        // The characters of the string were already read by the index
+        STATS_START(start);
+        *escaped = std::memchr(r->data + r->pos + 1, '\\', n) != nullptr;
+        STATS_ADD(rescanned_bytes, n);
+        STATS_STOP(string_ns, start);
+    }
+    STATS_START(start);
+    while (r->index == nullptr)
+    {
+        while (r->pos + 1 + n >= r->len)
+        {
+            if (!r->refill())
+            {
+                return false;
+            }
+        }
+
+        char c = r->data[r->pos + 1 + n];
+        if (c == '"')
+        {
+            break;
+        }
+        // The escaped character can't end the string
+        if (c == '\\')
+        {
+            *escaped = true;
+            n += 2;
+        }
+        else
+        {
+            ++n;
+        }
+    }
+
+    const char *chars = r->data + r->pos + 1;
+    r->pos += n + 1;
+    if (*escaped)
+    {
+        char *dst = scratch->reserve(n);
+        *str = dst;
+        *len = unescape_string(chars, n, dst);
+        STATS_ADD(rescanned_bytes, n);
+    }
+    else
+    {
+        *str = chars;
+        *len = n;
+    }
+    STATS_STOP(string_ns, start);
+    return true;
+}
+
+/**
+** \brief Parses the number that starts at the cursor of the reader, in place
+** \param r The reader, whose cursor is left on the last character of the number
+** \param n The parsed number
+** \returns false if the characters at the cursor are not a valid number
+*/
+bool parse_number(Reader *r, Number *n)
+{
+    STATS_START(start);
+    uint_fast64_t nb_chars = 0;
+    while (1)
+    {
+        nb_chars = read_number(r->data + r->pos, r->len - r->pos, n);
+        // If the characters of the number go up to the end of the window, the
+        // number may continue after it
+        uint_fast64_t end = r->pos + nb_chars;
+        while (end < r->len && IS_NUMBER_CHAR(r->data[end]))
+        {
+            ++end;
+        }
+        if (end < r->len || !r->refill())
+        {
+            break;
+        }
+    }
+
+    STATS_STOP(number_ns, start);
+    if (nb_chars == 0)
+    {
+        return false;
+    }
+    r->pos += nb_chars - 1;
+    return true;
+}
+
+/**
+** \returns Whether the number, boolean or null whose last character is at the
+**          cursor of the reader is followed by a character that can end it,
+**          or by the end of the input. The structural index only has the first
+**          character of these values, so the characters that follow them
+**          would be skipped by Reader::advance() without this check
+*/
+bool is_scalar_end(Reader *r)
+{
+    return !r->ensure(2) || IS_SCALAR_END(r->data[r->pos + 1]);
+}
+
+/**
+** \brief Moves the cursor of the reader past the character at the cursor (the
+**        end of the root container) and the whitespaces after it. The
+**        whitespaces are not part of the index, so an indexed buffer has no
+**        more tokens if only whitespaces are left
+** \returns Whether the input ends there
+*/
+bool is_input_end(Reader *r)
+{
+    r->advance();
+    while (r->ensure(1) && IS_WHITESPACE(r->data[r->pos]))
+    {
+        ++r->pos;
+    }
+    return !r->ensure(1);
+}
+
+/**
+** \brief Moves the cursor of the reader from the '[' or '{' that begins a
+**        container to the matching ']' or '}', without parsing the content of
+**        the container. If the buffer is indexed, only the structural
+**        characters are visited. Otherwise the characters are scanned (and
+**        the window refilled as many times as needed for file streams, so the
+**        skipped characters are not kept in memory)
+** \returns false if the input ended before the end of the container
+*/
+bool skip_container(Reader *r)
+{
+    uint_fast64_t depth = 0;
+    // The brackets that are inside strings are not part of the index
+    if (r->index != nullptr)
+    {
+        while (1)
+        {
+            char c = r->data[r->pos];
+            if (c == '[' || c == '{')
+            {
+                ++depth;
+            }
+            else if ((c == ']' || c == '}') && --depth == 0)
+            {
+                return true;
+            }
+            if (!r->index->next(&r->pos))
+            {
+                return false;
+            }
+        }
+    }
+
+    bool in_string = false;
+    // Whether the previous character is a backslash inside a string (which
+    // can be at the end of the window)
+    bool escaped = false;
+    while (r->pos < r->len || r->refill())
+    {
+        char c = r->data[r->pos];
+        if (escaped)
+        {
+            escaped = false;
+        }
+        else if (in_string)
+        {
+            escaped = c == '\\';
+            in_string = c != '"';
+        }
+        else if (c == '"')
+        {
+            in_string = true;
+        }
+        else if (c == '[' || c == '{')
+        {
+            ++depth;
+        }
+        else if ((c == ']' || c == '}') && --depth == 0)
+        {
+            return true;
+        }
+        ++r->pos;
+    }
+    return false;
+}
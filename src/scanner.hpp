@@ -0,0 +1,200 @@
+#ifndef SCANNER_HPP
+#define SCANNER_HPP
+
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <cstring>
+#include <stdint.h>
+
+#include "number.hpp"
+#include "reader.hpp"
+#include "stats.hpp"
+
+/*******************************************************************************
+**                              DEFINES / MACROS                              **
+*******************************************************************************/
+#define IS_NUMBER_START(c) (('0' <= (c) && (c) <= '9') || (c) == '-')
+#define IS_BOOL_START(c) ((c) == 't' || (c) == 'f')
+
+#define IS_NUMBER_CHAR(c)                                                      \
+    (('0' <= (c) && (c) <= '9') || (c) == '-' || (c) == '+' || (c) == '.'      \
+     || (c) == 'e' || (c) == 'E')
+
+#define IS_WHITESPACE(c)                                                       \
+    ((c) == ' ' || (c) == '\t' || (c) == '\n' || (c) == '\r')
+
+// Characters that can follow a number, a boolean or null
+#define IS_SCALAR_END(c)                                                       \
+    (IS_WHITESPACE(c) || (c) == ',' || (c) == ']' || (c) == '}')
+
+/**
+** \def Whether the 'n' characters of the literal 'lit' are at the cursor of
+**      the reader 'r'
+*/
+#define IS_LITERAL(r, lit, n)                                                  \
+    ((r)->ensure(n) && !std::memcmp((r)->data + (r)->pos, lit, n))
+
+// Initial size of the buffer in which the escaped strings are decoded
+#define BASE_SCRATCH_SIZE 256
+
+/**
+** \def Tokens that a container that is being read expects next (see Level) :
+**      its first value (or key) or its end, a value (or key) after a ',', the
+**      ':' after a key, the value of a key, and a ',' or its end after a value
+*/
+#define EXPECT_FIRST 0
+#define EXPECT_NEXT 1
+#define EXPECT_COLON 2
+#define EXPECT_VALUE 3
+#define EXPECT_COMMA 4
+
+/*******************************************************************************
+**                                   CLASSES                                  **
+*******************************************************************************/
+/**
+** \class Level State of a container that is being read by parse_container() or
+**              by a Cursor
+** \param is_array Whether the container is an array or a dict
+** \param expect The token that the container expects next (EXPECT_*)
+*/
+class Level
+{
+public:
+    bool is_array;
+    unsigned char expect;
+
+    /**
+    ** \returns Whether the container is a dict that waits for a key
+    */
+    bool wantsKey()
+    {
+        return !is_array && (expect == EXPECT_FIRST || expect == EXPECT_NEXT);
+    }
+
+    /**
+    ** \returns Whether the container waits for a value (an element of an
+    **          array, or the value of the key of a dict)
+    */
+    bool wantsValue()
+    {
+        return is_array ? expect == EXPECT_FIRST || expect == EXPECT_NEXT
+                        : expect == EXPECT_VALUE;
+    }
+
+    /**
+    ** \returns Whether the container can be closed (it is empty, or its last
+    **          value is complete)
+    */
+    bool canClose()
+    {
+        return expect == EXPECT_FIRST || expect == EXPECT_COMMA;
+    }
+
+    /**
+    ** \brief Reads the ',' or ':' 'c', which comes after a value or a key
+    ** \returns false if the container doesn't expect it
+    */
+    bool readSeparator(char c)
+    {
+        if (c == ',' && expect == EXPECT_COMMA)
+        {
+            expect = EXPECT_NEXT;
+            return true;
+        }
+        if (c == ':' && expect == EXPECT_COLON)
+        {
+            expect = EXPECT_VALUE;
+            return true;
+        }
+        return false;
+    }
+};
+
+/**
+** \class Scratch Buffer in which read_string() decodes the strings that
+**               contain escape sequences
+*/
+class Scratch
+{
+public:
+    char *buff;
+    uint_fast64_t size;
+
+    Scratch()
+        : buff(nullptr)
+        , size(0)
+    {}
+
+    ~Scratch()
+    {
+        delete[] buff;
+    }
+
+    /**
+    ** \returns The buffer, grown to at least 'n' characters
+    */
+    char *reserve(uint_fast64_t n)
+    {
+        if (n > size)
+        {
+            delete[] buff;
+            size = n < BASE_SCRATCH_SIZE ? BASE_SCRATCH_SIZE : n * 2;
+            STATS_ALLOC(size);
+            buff = new char[size];
+        }
+        return buff;
+    }
+};
+
+/*******************************************************************************
+**                                 FUNCTIONS                                  **
+*******************************************************************************/
+/**
+** \brief Decodes the escape sequences of the 'len' characters of a json string
+**        at 'src' into 'dst', which is at least 'len' characters long
+** \returns The number of decoded characters
+*/
+uint_fast64_t unescape_string(const char *src, uint_fast64_t len, char *dst);
+
+/**
+** \brief Reads the string that starts at the cursor of the reader (on the '"')
+**        and leaves the cursor on the '"' that ends it
+** \param str Set to the characters of the string (with its escape sequences
+**            decoded), which point into the input of the reader if 'escaped'
+**            is false, into the scratch buffer otherwise
+** \returns false if the input ended before the end of the string
+*/
+bool read_string(Reader *r, Scratch *scratch, const char **str,
+                 uint_fast64_t *len, bool *escaped);
+
+/**
+** \brief Parses the number that starts at the cursor of the reader, and leaves
+**        the cursor on its last character
+** \returns false if the characters at the cursor are not a valid number
+*/
+bool parse_number(Reader *r, Number *n);
+
+/**
+** \returns Whether the number, boolean or null whose last character is at the
+**          cursor of the reader is followed by a character that can end it,
+**          or by the end of the input
+*/
+bool is_scalar_end(Reader *r);
+
+/**
+** \brief Moves the cursor of the reader past the character at the cursor (the
+**        end of the root container) and the whitespaces after it
+** \returns Whether the input ends there
+*/
+bool is_input_end(Reader *r);
+
+/**
+** \brief Moves the cursor of the reader from the '[' or '{' that begins a
+**        container to the matching ']' or '}', without parsing the content of
+**        the container
+** \returns false if the input ended before the end of the container
+*/
+bool skip_container(Reader *r);
+
+#endif // !SCANNER_HPP
@@ -0,0 +1,501 @@
+#include "serializer.hpp"
+
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <unistd.h>
+
+#include "number.hpp"
+
+/*******************************************************************************
+**                                   TABLES                                   **
+*******************************************************************************/
+// Tabs used for the indentation, written INDENT_TABLE_SIZE at a time at most
+#define INDENT_TABLE_SIZE 64
+static const char TABS[INDENT_TABLE_SIZE + 1] =
+    "\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t"
+    "\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t";
+
+/**
+** \brief For each character, 0 if it can appear as is in a json string, the
+**        character of its escape sequence otherwise ('u' for the ones that
+**        are written as \u00XX)
+*/
+static const char ESCAPES[256] = {
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    'u', 'u', 0,   0,   '"', 0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   '\\'
+};
+
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+/*******************************************************************************
+**                              LOCAL FUNCTIONS                               **
+*******************************************************************************/
+/**
+** \brief Writes the 'len' characters at 'str' to the file descriptor 'fd',
+**        retrying the interrupted and partial writes
+** \returns false if a write failed
+*/
+static bool write_all(int fd, const char *str, uint_fast64_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n = ::write(fd, str, len);
+        if (n < 0 && errno != EINTR)
+        {
+            return false;
+        }
+        n = n > 0 ? n : 0;
+        str += n;
+        len -= n;
+    }
+    return true;
+}
+
+/*******************************************************************************
+**                                 SERIALIZER                                 **
+*******************************************************************************/
+/**
+** \brief Creates a serializer that writes in a buffer that grows to contain the
+**        whole text (see getData())
+*/
+Serializer::Serializer(bool pretty)
+    : fd(-1)
+    , pretty(pretty)
+    , buff(new char[SERIALIZER_BUFF_SIZE])
+    , size(0)
+    , capacity(SERIALIZER_BUFF_SIZE)
+    , failed(false)
+{}
+
+/**
+** \brief Creates a serializer that writes to the given file descriptor, through
+**        a buffer of SERIALIZER_BUFF_SIZE characters
+*/
+Serializer::Serializer(int fd, bool pretty)
+    : fd(fd)
+    , pretty(pretty)
+    , buff(new char[SERIALIZER_BUFF_SIZE])
+    , size(0)
+    , capacity(SERIALIZER_BUFF_SIZE)
+    , failed(false)
+{}
+
+Serializer::~Serializer()
+{
+    flush();
+    delete[] buff;
+}
+
+/**
+** \brief Makes sure that 'n' characters fit in the buffer, by flushing it if
+**        there is a file descriptor (in which case 'n' must not be greater than
+**        the capacity), by growing it otherwise
+*/
+void Serializer::reserve(uint_fast64_t n)
+{
+    if (capacity - size >= n)
+    {
+        return;
+    }
+
+    if (fd != -1)
+    {
+        flush();
+        return;
+    }
+
+    uint_fast64_t new_capacity = capacity * 2;
+    while (new_capacity - size < n)
+    {
+        new_capacity *= 2;
+    }
+    char *tmp = new char[new_capacity];
+    std::memcpy(tmp, buff, size);
+    delete[] buff;
+    buff = tmp;
+    capacity = new_capacity;
+}
+
+/**
+** \brief Writes the remaining characters of the buffer to the file descriptor
+**        (does nothing if there is no file descriptor)
+** \returns false if a write to the file descriptor failed
+*/
+bool Serializer::flush()
+{
+    if (fd == -1)
+    {
+        return true;
+    }
+
+    if (!failed && !write_all(fd, buff, size))
+    {
+        failed = true;
+    }
+    size = 0;
+    return !failed;
+}
+
+/**
+** \brief Writes all the characters of the buffer to the given file descriptor
+**        at once (for a serializer without file descriptor)
+** \returns false if a write failed
+*/
+bool Serializer::writeTo(int out_fd)
+{
+    return write_all(out_fd, buff, size);
+}
+
+/**
+** \returns The characters written so far (when there is no file descriptor),
+**          not null terminated
+*/
+const char *Serializer::getData()
+{
+    return buff;
+}
+
+uint_fast64_t Serializer::getSize()
+{
+    return size;
+}
+
+/**
+** \brief Writes the given characters as is
+*/
+void Serializer::writeChars(const char *str, uint_fast64_t len)
+{
+    if (capacity - size < len)
+    {
+        reserve(len);
+        // Too large for the buffer of the file descriptor
+        if (capacity - size < len)
+        {
+            if (!failed && !write_all(fd, str, len))
+            {
+                failed = true;
+            }
+            return;
+        }
+    }
+    std::memcpy(buff + size, str, len);
+    size += len;
+}
+
+/**
+** \brief Writes the given characters between quotes, escaping the ones that
+**        can't appear as is in a json string
+*/
+void Serializer::writeString(const char *str, uint_fast64_t len)
+{
+    writeChar('"');
+    // Start of the characters that don't have to be escaped
+    uint_fast64_t start = 0;
+    for (uint_fast64_t i = 0; i < len; ++i)
+    {
+        unsigned char c = str[i];
+        char escape = ESCAPES[c];
+        if (escape == 0)
+        {
+            continue;
+        }
+
+        writeChars(str + start, i - start);
+        start = i + 1;
+        reserve(6);
+        buff[size++] = '\\';
+        buff[size++] = escape;
+        if (escape == 'u')
+        {
+            buff[size++] = '0';
+            buff[size++] = '0';
+            buff[size++] = HEX_DIGITS[c >> 4];
+            buff[size++] = HEX_DIGITS[c & 0xf];
+        }
+    }
+    writeChars(str + start, len - start);
+    writeChar('"');
+}
+
+void Serializer::writeInt(int_fast64_t i)
+{
+    reserve(NUMBER_BUFF_SIZE);
+    size += write_int(i, buff + size);
+}
+
+/**
+** \brief Writes the shortest representation of the double that is read back
+**        as the same double. Infinities and NaN can't be represented in json,
+**        so they are written as null
+*/
+void Serializer::writeDouble(double d)
+{
+    if (!std::isfinite(d))
+    {
+        writeChars("null", 4);
+        return;
+    }
+    reserve(NUMBER_BUFF_SIZE);
+    size += write_double(d, buff + size);
+}
+
+void Serializer::writeIndent(uint_fast64_t depth)
+{
+    while (depth > INDENT_TABLE_SIZE)
+    {
+        writeChars(TABS, INDENT_TABLE_SIZE);
+        depth -= INDENT_TABLE_SIZE;
+    }
+    writeChars(TABS, depth);
+}
+
+/**
+** \brief Writes the given array, whose values are at the given depth + 1
+*/
+void Serializer::writeArray(JSONArray *ja, uint_fast64_t depth)
+{
+    uint_fast64_t nb_values = ja->getSize();
+    Value *values = ja->getValues();
+    writeChar('[');
+    for (uint_fast64_t i = 0; i < nb_values; ++i)
+    {
+        if (i > 0)
+        {
+            writeChar(',');
+        }
+        if (pretty)
+        {
+            writeChar('\n');
+            writeIndent(depth + 1);
+        }
+        writeValue(values + i, depth + 1);
+    }
+    if (pretty && nb_values > 0)
+    {
+        writeChar('\n');
+        writeIndent(depth);
+    }
+    writeChar(']');
+}
+
+/**
+** \brief Writes the given dict, whose items are at the given depth + 1
+*/
+void Serializer::writeDict(JSONDict *jd, uint_fast64_t depth)
+{
+    uint_fast64_t nb_items = jd->getSize();
+    Item *items = jd->getItems();
+    writeChar('{');
+    for (uint_fast64_t i = 0; i < nb_items; ++i)
+    {
+        if (i > 0)
+        {
+            writeChar(',');
+        }
+        if (pretty)
+        {
+            writeChar('\n');
+            writeIndent(depth + 1);
+        }
+
+        String *key = items[i].getKey();
+        writeString(key->str(), key->len());
+        writeChar(':');
+        if (pretty)
+        {
+            writeChar(' ');
+        }
+        writeValue(items[i].getValue(), depth + 1);
+    }
+    if (pretty && nb_items > 0)
+    {
+        writeChar('\n');
+        writeIndent(depth);
+    }
+    writeChar('}');
+}
+
+void Serializer::writeValue(Value *v, uint_fast64_t depth)
+{
+    switch (v->getType())
+    {
+    case T_STR:
+        writeString(v->getString()->str(), v->getString()->len());
+        break;
+    case T_INT:
+        writeInt(v->getInt());
+        break;
+    case T_DOUBLE:
+        writeDouble(v->getDouble());
+        break;
+    case T_BOOL:
+        if (v->getBool())
+        {
+            writeChars("true", 4);
+        }
+        else
+        {
+            writeChars("false", 5);
+        }
+        break;
+    case T_NULL:
+        writeChars("null", 4);
+        break;
+    // A lazy container whose content is invalid is nullptr
+    case T_ARR:
+        if (v->getArray() == nullptr)
+        {
+            writeChars("null", 4);
+        }
+        else
+        {
+            writeArray(v->getArray(), depth);
+        }
+        break;
+    case T_DICT:
+        if (v->getDict() == nullptr)
+        {
+            writeChars("null", 4);
+        }
+        else
+        {
+            writeDict(v->getDict(), depth);
+        }
+        break;
+    }
+}
+
+void Serializer::writeValue(Value *v)
+{
+    writeValue(v, 0);
+}
+
+void Serializer::writeJSON(JSON *j)
+{
+    if (j->isArray())
+    {
+        writeArray((JSONArray *)j, 0);
+    }
+    else
+    {
+        writeDict((JSONDict *)j, 0);
+    }
+}
+
+/**
+** \brief Writes the given array of a tape, like writeArray(JSONArray *)
+*/
+void Serializer::writeArray(TapeArray ta, uint_fast64_t depth)
+{
+    uint_fast64_t nb_values = ta.getSize();
+    TapeValue v = ta.getFirst();
+    writeChar('[');
+    for (uint_fast64_t i = 0; i < nb_values; ++i, v = v.getNext())
+    {
+        if (i > 0)
+        {
+            writeChar(',');
+        }
+        if (pretty)
+        {
+            writeChar('\n');
+            writeIndent(depth + 1);
+        }
+        writeValue(v, depth + 1);
+    }
+    if (pretty && nb_values > 0)
+    {
+        writeChar('\n');
+        writeIndent(depth);
+    }
+    writeChar(']');
+}
+
+/**
+** \brief Writes the given dict of a tape, like writeDict(JSONDict *)
+*/
+void Serializer::writeDict(TapeDict td, uint_fast64_t depth)
+{
+    uint_fast64_t nb_items = td.getSize();
+    TapeItem item = td.getFirst();
+    writeChar('{');
+    for (uint_fast64_t i = 0; i < nb_items; ++i, item = item.getNext())
+    {
+        if (i > 0)
+        {
+            writeChar(',');
+        }
+        if (pretty)
+        {
+            writeChar('\n');
+            writeIndent(depth + 1);
+        }
+
+        String key = item.getKey();
+        writeString(key.str(), key.len());
+        writeChar(':');
+        if (pretty)
+        {
+            writeChar(' ');
+        }
+        writeValue(item.getValue(), depth + 1);
+    }
+    if (pretty && nb_items > 0)
+    {
+        writeChar('\n');
+        writeIndent(depth);
+    }
+    writeChar('}');
+}
+
+void Serializer::writeValue(TapeValue v, uint_fast64_t depth)
+{
+    switch (v.getType())
+    {
+    case T_STR:
+    {
+        String s = v.getString();
+        writeString(s.str(), s.len());
+        break;
+    }
+    case T_INT:
+        writeInt(v.getInt());
+        break;
+    case T_DOUBLE:
+        writeDouble(v.getDouble());
+        break;
+    case T_BOOL:
+        if (v.getBool())
+        {
+            writeChars("true", 4);
+        }
+        else
+        {
+            writeChars("false", 5);
+        }
+        break;
+    case T_NULL:
+        writeChars("null", 4);
+        break;
+    case T_ARR:
+        writeArray(v.getArray(), depth);
+        break;
+    case T_DICT:
+        writeDict(v.getDict(), depth);
+        break;
+    }
+}
+
+void Serializer::writeTape(Tape *t)
+{
+    writeValue(t->getRoot(), 0);
+}
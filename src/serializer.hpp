@@ -0,0 +1,88 @@
+#ifndef SERIALIZER_HPP
+#define SERIALIZER_HPP
+
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <stdint.h>
+
+#include "json.hpp"
+#include "tape.hpp"
+
+/*******************************************************************************
+**                              DEFINES / MACROS                              **
+*******************************************************************************/
+#ifndef SERIALIZER_BUFF_SIZE
+#    define SERIALIZER_BUFF_SIZE (1 << 16) // 64 KiB
+#endif
+
+/*******************************************************************************
+**                                   CLASSES                                  **
+*******************************************************************************/
+/**
+** \class Serializer Writes json objects as text
+** \brief The text is written in a buffer, which either grows to contain the
+**        whole text, or is flushed to a file descriptor each time it is full
+**        (and when the serializer is destroyed).
+**        The tapes (see Tape) are written the same way as the json objects.
+**        The objects are either pretty printed (one value per line, indented
+**        with tabs) or minified (without any whitespace)
+** \param fd The file descriptor to which the buffer is flushed, -1 if the
+**           buffer grows instead
+** \param pretty Whether the objects are pretty printed or minified
+** \param buff The characters that are not yet flushed
+** \param size The number of characters in the buffer
+** \param capacity The number of characters that fit in the buffer
+** \param failed Whether writing to the file descriptor failed
+*/
+class Serializer
+{
+private:
+    int fd;
+    bool pretty;
+    char *buff;
+    uint_fast64_t size;
+    uint_fast64_t capacity;
+    bool failed;
+
+    void reserve(uint_fast64_t n);
+    void writeIndent(uint_fast64_t depth);
+    void writeArray(JSONArray *ja, uint_fast64_t depth);
+    void writeDict(JSONDict *jd, uint_fast64_t depth);
+    void writeValue(Value *v, uint_fast64_t depth);
+    void writeArray(TapeArray ta, uint_fast64_t depth);
+    void writeDict(TapeDict td, uint_fast64_t depth);
+    void writeValue(TapeValue v, uint_fast64_t depth);
+
+public:
+    Serializer(bool pretty);
+    Serializer(int fd, bool pretty);
+    ~Serializer();
+
+    /**
+    ** \brief Writes the given character as is
+    */
+    void writeChar(char c)
+    {
+        if (size == capacity)
+        {
+            reserve(1);
+        }
+        buff[size++] = c;
+    }
+
+    void writeChars(const char *str, uint_fast64_t len);
+    void writeString(const char *str, uint_fast64_t len);
+    void writeInt(int_fast64_t i);
+    void writeDouble(double d);
+    void writeValue(Value *v);
+    void writeJSON(JSON *j);
+    void writeTape(Tape *t);
+
+    bool flush();
+    bool writeTo(int out_fd);
+    const char *getData();
+    uint_fast64_t getSize();
+};
+
+#endif // !SERIALIZER_HPP
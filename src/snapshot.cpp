@@ -0,0 +1,417 @@
+#include "snapshot.hpp"
+
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "array_list.hpp"
+#include "parser.hpp"
+
+/*******************************************************************************
+**                                   CLASSES                                  **
+*******************************************************************************/
+/**
+** \class OpenContainer Container whose end is not reached yet by check_words()
+** \param start The position of its first word
+** \param nb_values The number of values (and keys) read in it so far
+*/
+class OpenContainer
+{
+public:
+    uint_fast64_t start;
+    uint_fast64_t nb_values;
+};
+
+/*******************************************************************************
+**                              LOCAL FUNCTIONS                               **
+*******************************************************************************/
+/**
+** \brief Hashes the given characters (64 bits FNV-1a, like hash_str(), but for
+**        any number of characters)
+*/
+static uint64_t hash_chars(const char *chars, uint_fast64_t len)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (uint_fast64_t i = 0; i < len; ++i)
+    {
+        h ^= (unsigned char)chars[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+/**
+** \brief Hashes the characters of the given file
+** \param fd The file descriptor of the file
+** \param size The size of the file
+** \returns false if the file could not be mapped
+*/
+static bool hash_file(int fd, uint_fast64_t size, uint64_t *hash)
+{
+    // Empty files can't be mapped
+    if (size == 0)
+    {
+        *hash = hash_chars(nullptr, 0);
+        return true;
+    }
+
+    void *m = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (m == MAP_FAILED)
+    {
+        return false;
+    }
+    // Only a hint to the kernel, so the error is ignored
+    madvise(m, size, MADV_SEQUENTIAL);
+    *hash = hash_chars((const char *)m, size);
+    munmap(m, size);
+    return true;
+}
+
+/**
+** \brief Fills the header of the snapshot of the given tape
+** \param st The status of the source of the tape, taken before it was read
+** \param hash The hash of the characters of the source
+*/
+static void fill_header(SnapshotHeader *h, Tape *tape, struct stat *st,
+                        uint64_t hash)
+{
+    std::memset(h, 0, sizeof(SnapshotHeader));
+    std::memcpy(h->magic, SNAPSHOT_MAGIC, sizeof(h->magic));
+    h->version = SNAPSHOT_VERSION;
+    h->nb_words = tape->getNbWords();
+    h->nb_chars = tape->getNbChars();
+    h->source_size = st->st_size;
+    h->source_mtime_sec = st->st_mtim.tv_sec;
+    h->source_mtime_nsec = st->st_mtim.tv_nsec;
+    h->source_hash = hash;
+}
+
+/**
+** \brief Writes the header and the tape in a temporary file next to the
+**        snapshot, which then replaces the snapshot
+** \returns false if the snapshot could not be written
+*/
+static bool write_snapshot(SnapshotHeader *h, Tape *tape, char *snapshot)
+{
+    // The temporary file is in the same directory, so that it can be renamed,
+    // and has a unique name, so that the threads and processes that write the
+    // same snapshot at the same time don't write in the same file
+    uint_fast64_t len = strlen(snapshot) + 8;
+    char *tmp = new char[len];
+    snprintf(tmp, len, "%s.XXXXXX", snapshot);
+    int fd = mkstemp(tmp);
+    if (fd == -1)
+    {
+        delete[] tmp;
+        return false;
+    }
+
+    FILE *f = fdopen(fd, "wb");
+    if (f == nullptr)
+    {
+        close(fd);
+    }
+    // mkstemp() creates the file readable by its owner only, the snapshot is
+    // read by the other processes
+    bool ok = f != nullptr && fchmod(fd, 0644) == 0
+        && fwrite(h, sizeof(SnapshotHeader), 1, f) == 1
+        && fwrite(tape->getWords(), sizeof(uint64_t), h->nb_words, f)
+            == h->nb_words
+        && fwrite(tape->getChars(), sizeof(char), h->nb_chars, f)
+            == h->nb_chars;
+    if (f != nullptr && fclose(f) != 0)
+    {
+        ok = false;
+    }
+
+    ok = ok && rename(tmp, snapshot) == 0;
+    if (!ok)
+    {
+        unlink(tmp);
+    }
+    delete[] tmp;
+    return ok;
+}
+
+/**
+** \returns Whether the header is the one of a snapshot of this version, whose
+**          tape has the size of the rest of the file and ends where its root
+**          ends
+*/
+static bool is_valid(SnapshotHeader *h, uint_fast64_t size)
+{
+    if (std::memcmp(h->magic, SNAPSHOT_MAGIC, sizeof(h->magic)) != 0
+        || h->version != SNAPSHOT_VERSION)
+    {
+        return false;
+    }
+
+    // The smallest tape is an empty container, in 3 words
+    uint_fast64_t rest = size - sizeof(SnapshotHeader);
+    if (h->nb_words < 3 || h->nb_words > rest / sizeof(uint64_t)
+        || h->nb_chars != rest - h->nb_words * sizeof(uint64_t))
+    {
+        return false;
+    }
+
+    uint64_t root = *(uint64_t *)(h + 1);
+    return (TAPE_TAG(root) == T_ARR || TAPE_TAG(root) == T_DICT)
+        && TAPE_PAYLOAD(root) == h->nb_words - 1;
+}
+
+/**
+** \brief Checks all the words of the tape of a snapshot, as the views on the
+**        tape read them without any check : the file may have been truncated,
+**        corrupted or written by something else with a valid header
+** \returns Whether the words are a single container, in which each container
+**          is ended by the word at the position it gives, which gives back its
+**          start, and has the number of values (or items) it gives, the keys
+**          of the dicts are strings, the tags are known, and the characters of
+**          each string and their '\0' are in the buffer of characters
+*/
+static bool check_words(uint64_t *words, uint_fast64_t nb_words,
+                        const char *chars, uint_fast64_t nb_chars)
+{
+    ArrayList<OpenContainer> open;
+    uint_fast64_t pos = 0;
+    while (pos < nb_words)
+    {
+        unsigned char tag = TAPE_TAG(words[pos]);
+        uint_fast64_t payload = TAPE_PAYLOAD(words[pos]);
+        uint_fast64_t depth = open.getSize();
+        // Only the root is outside of a container
+        if (tag > TAPE_END || (depth == 0 && pos != 0))
+        {
+            return false;
+        }
+
+        if (tag == TAPE_END)
+        {
+            OpenContainer *c = depth == 0 ? nullptr : open.get(depth - 1);
+            if (c == nullptr || payload != c->start
+                || TAPE_PAYLOAD(words[c->start]) != pos)
+            {
+                return false;
+            }
+            // The values of a dict come in pairs of a key and a value
+            bool is_dict = TAPE_TAG(words[c->start]) == T_DICT;
+            uint_fast64_t nb = is_dict ? c->nb_values / 2 : c->nb_values;
+            if ((is_dict && c->nb_values % 2 != 0) || words[c->start + 1] != nb)
+            {
+                return false;
+            }
+            open.remove(depth - 1);
+            ++pos;
+            continue;
+        }
+
+        if (depth > 0)
+        {
+            OpenContainer *c = open.get(depth - 1);
+            if (TAPE_TAG(words[c->start]) == T_DICT && c->nb_values % 2 == 0
+                && tag != T_STR)
+            {
+                return false;
+            }
+            ++c->nb_values;
+        }
+
+        if (TAPE_NB_WORDS(tag) > nb_words - pos)
+        {
+            return false;
+        }
+        if (tag == T_ARR || tag == T_DICT)
+        {
+            OpenContainer c = { pos, 0 };
+            open.add(c);
+        }
+        else if (tag == T_STR)
+        {
+            uint_fast64_t len = words[pos + 1];
+            if (len >= nb_chars || payload >= nb_chars - len
+                || chars[payload + len] != '\0')
+            {
+                return false;
+            }
+        }
+        pos += TAPE_NB_WORDS(tag);
+    }
+    return open.getSize() == 0;
+}
+
+/**
+** \brief Writes the time of modification of the source in the header of the
+**        snapshot, so that its next loadings don't hash the source again. The
+**        header is only a hint for them, so the errors are ignored
+*/
+static void refresh_mtime(char *snapshot, struct stat *st)
+{
+    int fd = open(snapshot, O_WRONLY);
+    if (fd == -1)
+    {
+        return;
+    }
+
+    int64_t mtime[2] = { st->st_mtim.tv_sec, st->st_mtim.tv_nsec };
+    ssize_t n = pwrite(fd, mtime, sizeof(mtime),
+                       offsetof(SnapshotHeader, source_mtime_sec));
+    (void)n;
+    close(fd);
+}
+
+/**
+** \returns Whether the source still has the size of the header, and either
+**          the same time of modification or the same hash
+*/
+static bool is_up_to_date(SnapshotHeader *h, char *source, char *snapshot)
+{
+    int fd = open(source, O_RDONLY);
+    if (fd == -1)
+    {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (uint64_t)st.st_size != h->source_size)
+    {
+        close(fd);
+        return false;
+    }
+
+    bool ok = st.st_mtim.tv_sec == h->source_mtime_sec
+        && st.st_mtim.tv_nsec == h->source_mtime_nsec;
+    // The file was written (or copied) again, maybe with the same content
+    uint64_t hash = 0;
+    if (!ok && hash_file(fd, st.st_size, &hash) && hash == h->source_hash)
+    {
+        ok = true;
+        refresh_mtime(snapshot, &st);
+    }
+    close(fd);
+    return ok;
+}
+
+/*******************************************************************************
+**                                 FUNCTIONS                                  **
+*******************************************************************************/
+bool save_snapshot(Tape *tape, char *source, char *snapshot)
+{
+    if (tape == nullptr || source == nullptr || snapshot == nullptr)
+    {
+        return false;
+    }
+
+    int fd = open(source, O_RDONLY);
+    if (fd == -1)
+    {
+        return false;
+    }
+
+    struct stat st;
+    uint64_t hash = 0;
+    bool ok = fstat(fd, &st) == 0 && S_ISREG(st.st_mode)
+        && hash_file(fd, st.st_size, &hash);
+    close(fd);
+    if (!ok)
+    {
+        return false;
+    }
+
+    SnapshotHeader h;
+    fill_header(&h, tape, &st, hash);
+    return write_snapshot(&h, tape, snapshot);
+}
+
+Tape *load_snapshot(char *source, char *snapshot)
+{
+    if (source == nullptr || snapshot == nullptr)
+    {
+        return nullptr;
+    }
+
+    int fd = open(snapshot, O_RDONLY);
+    if (fd == -1)
+    {
+        return nullptr;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)
+        || (uint_fast64_t)st.st_size < sizeof(SnapshotHeader))
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    void *m = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    SnapshotHeader *h = (SnapshotHeader *)m;
+    uint64_t *words = (uint64_t *)(h + 1);
+    if (!is_valid(h, st.st_size) || !is_up_to_date(h, source, snapshot)
+        || !check_words(words, h->nb_words, (char *)(words + h->nb_words),
+                        h->nb_chars))
+    {
+        munmap(m, st.st_size);
+        return nullptr;
+    }
+
+    return new Tape(m, st.st_size, words, h->nb_words,
+                    (char *)(words + h->nb_words), h->nb_chars);
+}
+
+Tape *parse_cached(char *file, char *snapshot)
+{
+    Tape *tape = load_snapshot(file, snapshot);
+    if (tape != nullptr)
+    {
+        return tape;
+    }
+
+    int fd = file == nullptr ? -1 : open(file, O_RDONLY);
+    if (fd == -1)
+    {
+        return nullptr;
+    }
+
+    // Only the regular files have a snapshot
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0)
+    {
+        close(fd);
+        return parse_tape(file);
+    }
+
+    // The file is mapped once to be parsed and hashed, so that the snapshot
+    // can't be given the hash of another version of the file
+    void *m = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED)
+    {
+        return parse_tape(file);
+    }
+    // Only a hint to the kernel, so the error is ignored
+    madvise(m, st.st_size, MADV_SEQUENTIAL);
+
+    tape = parse_tape((const char *)m, st.st_size);
+    if (tape != nullptr && snapshot != nullptr)
+    {
+        SnapshotHeader h;
+        fill_header(&h, tape, &st, hash_chars((const char *)m, st.st_size));
+        write_snapshot(&h, tape, snapshot);
+    }
+    munmap(m, st.st_size);
+    return tape;
+}
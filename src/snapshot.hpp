@@ -0,0 +1,96 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <stdint.h>
+
+#include "tape.hpp"
+
+/*******************************************************************************
+**                              DEFINES / MACROS                              **
+*******************************************************************************/
+// First characters of the snapshots
+#define SNAPSHOT_MAGIC "JSONTAPE"
+
+/**
+** \def Version of the format of the snapshots, incremented each time the
+**      header or the words of the tapes change
+*/
+#define SNAPSHOT_VERSION 1
+
+/*******************************************************************************
+**                                   CLASSES                                  **
+*******************************************************************************/
+/**
+** \class SnapshotHeader Beginning of a snapshot, followed by the words of the
+**                       tape and then by its characters
+** \brief The words and the sizes are stored in the byte order of the machine
+**        that wrote them, so a snapshot written by a machine with another byte
+**        order has a wrong version and is ignored
+** \param magic SNAPSHOT_MAGIC
+** \param version SNAPSHOT_VERSION
+** \param nb_words The number of words of the tape
+** \param nb_chars The number of characters of the tape
+** \param source_size The size of the parsed file
+** \param source_mtime_sec The time of the last modification of the parsed
+**                         file, in seconds
+** \param source_mtime_nsec The nanoseconds of this time
+** \param source_hash The hash of the characters of the parsed file
+*/
+class SnapshotHeader
+{
+public:
+    char magic[8];
+    uint64_t version;
+    uint64_t nb_words;
+    uint64_t nb_chars;
+    uint64_t source_size;
+    int64_t source_mtime_sec;
+    int64_t source_mtime_nsec;
+    uint64_t source_hash;
+};
+
+static_assert(sizeof(SnapshotHeader) == 64,
+              "The words of a snapshot must start at an aligned position");
+
+/*******************************************************************************
+**                                 FUNCTIONS                                  **
+*******************************************************************************/
+/**
+** \brief Writes the given tape, parsed from the file 'source', to the file
+**        'snapshot', along with the size, the time of modification and the
+**        hash of the source. The snapshot is written in a temporary file that
+**        is then renamed, so a process that reads it never sees it partially
+**        written
+** \returns false if the source or the snapshot could not be read or written
+*/
+bool save_snapshot(Tape *tape, char *source, char *snapshot);
+
+/**
+** \brief Maps the given snapshot of the file 'source' in memory and returns it
+**        as a tape, without parsing anything : its words and characters are
+**        read directly from the mapping.
+**        The snapshot is only used if the source still has the size it had
+**        when the snapshot was written, and the same time of modification or,
+**        if it changed, the same hash (which is only computed in this case).
+**        The snapshot is not trusted : its words are all checked once (the
+**        positions of the containers, their sizes, the keys and the bounds of
+**        the strings), so that a corrupted one is not read out of bounds
+** \returns The tape, which the caller has to delete, or nullptr if there is no
+**          snapshot, if it is out of date or if its words are not valid
+*/
+Tape *load_snapshot(char *source, char *snapshot);
+
+/**
+** \brief Loads the snapshot of the given file if it is up to date, otherwise
+**        parses the file with parse_tape() and writes its snapshot for the
+**        next calls (and processes). The snapshot is not needed for the
+**        parsing, so failing to write it is ignored
+** \returns The tape, which the caller has to delete, or nullptr if the file is
+**          not a valid json array or dict
+*/
+Tape *parse_cached(char *file, char *snapshot);
+
+#endif // !SNAPSHOT_HPP
@@ -0,0 +1,34 @@
+#include "stats.hpp"
+
+/*******************************************************************************
+**                                PARSE STATS                                 **
+*******************************************************************************/
+/**
+** \brief Prints the statistics in the given stream, one per line
+*/
+void ParseStats::print(FILE *out)
+{
+#ifndef ENABLE_PARSE_STATS
+    fprintf(out, "Parse statistics disabled (compile with "
+                 "-DENABLE_PARSE_STATS)\n");
+#endif
+    fprintf(out, "bytes read      : %lu\n", (unsigned long)bytes_read);
+    fprintf(out, "total           : %.3f ms\n", total_ns / 1e6);
+    fprintf(out, "  io            : %.3f ms\n", io_ns / 1e6);
+    fprintf(out, "  index         : %.3f ms\n", index_ns / 1e6);
+    fprintf(out, "  strings       : %.3f ms\n", string_ns / 1e6);
+    fprintf(out, "  numbers       : %.3f ms\n", number_ns / 1e6);
+    fprintf(out, "  build         : %.3f ms\n", build_ns / 1e6);
+    fprintf(out, "arrays          : %lu\n", (unsigned long)nb_arrays);
+    fprintf(out, "dicts           : %lu\n", (unsigned long)nb_dicts);
+    fprintf(out, "keys            : %lu\n", (unsigned long)nb_keys);
+    fprintf(out, "strings         : %lu\n", (unsigned long)nb_strings);
+    fprintf(out, "ints            : %lu\n", (unsigned long)nb_ints);
+    fprintf(out, "doubles         : %lu\n", (unsigned long)nb_doubles);
+    fprintf(out, "bools           : %lu\n", (unsigned long)nb_bools);
+    fprintf(out, "nulls           : %lu\n", (unsigned long)nb_nulls);
+    fprintf(out, "max depth       : %lu\n", (unsigned long)max_depth);
+    fprintf(out, "allocations     : %lu (%lu bytes)\n",
+            (unsigned long)nb_allocs, (unsigned long)alloc_bytes);
+    fprintf(out, "rescanned bytes : %lu\n", (unsigned long)rescanned_bytes);
+}
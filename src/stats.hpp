@@ -0,0 +1,154 @@
+#ifndef STATS_HPP
+#define STATS_HPP
+
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef ENABLE_PARSE_STATS
+#    include <chrono>
+#endif
+
+/*******************************************************************************
+**                                   CLASSES                                  **
+*******************************************************************************/
+/**
+** \class ParseStats Statistics of a parsing, filled by
+**                   parse(file, use_arena, stats)
+** \brief The statistics are only collected if ENABLE_PARSE_STATS is defined,
+**        they all stay at 0 otherwise (and the instrumentation of the parser
+**        is compiled out). Collecting them slows the parsing down, mostly
+**        because of the timing of each string and number
+** \param bytes_read The number of characters of the input
+** \param total_ns The time of the whole parsing, in nanoseconds
+** \param io_ns The time spent reading the input (mapping the file, reading it
+**              in a buffer or refilling the window of a stream). The pages of
+**              a mapped file are only read when they are first accessed, so
+**              their I/O is counted in the phases that access them
+** \param index_ns The time spent building the structural index (the pass over
+**                 the input that finds its tokens before they are parsed)
+** \param string_ns The time spent reading and decoding the strings and keys
+** \param number_ns The time spent parsing the numbers
+** \param build_ns The rest of the time : reading the structure of the input
+**                 and building the json object
+** \param nb_* The number of values of each type (nb_keys being the number of
+**             keys of the dicts)
+** \param max_depth The maximum number of nested containers
+** \param nb_allocs The number of heap allocations made by the parsing (nodes,
+**                  strings, storage of the containers, blocks of the arena
+**                  and buffers of the parser)
+** \param alloc_bytes The number of bytes of these allocations
+** \param rescanned_bytes The number of characters of the input that were read
+**                        more than once : the strings are found by the
+**                        structural index, then searched for escape sequences
+**                        (and decoded if they have some), and the containers
+**                        that are skipped by a lazy parsing are read again when
+**                        they are accessed
+*/
+class ParseStats
+{
+public:
+    uint_fast64_t bytes_read = 0;
+
+    uint_fast64_t total_ns = 0;
+    uint_fast64_t io_ns = 0;
+    uint_fast64_t index_ns = 0;
+    uint_fast64_t string_ns = 0;
+    uint_fast64_t number_ns = 0;
+    uint_fast64_t build_ns = 0;
+
+    uint_fast64_t nb_arrays = 0;
+    uint_fast64_t nb_dicts = 0;
+    uint_fast64_t nb_keys = 0;
+    uint_fast64_t nb_strings = 0;
+    uint_fast64_t nb_ints = 0;
+    uint_fast64_t nb_doubles = 0;
+    uint_fast64_t nb_bools = 0;
+    uint_fast64_t nb_nulls = 0;
+    uint_fast64_t max_depth = 0;
+
+    uint_fast64_t nb_allocs = 0;
+    uint_fast64_t alloc_bytes = 0;
+    uint_fast64_t rescanned_bytes = 0;
+
+    void print(FILE *out);
+};
+
+/*******************************************************************************
+**                              DEFINES / MACROS                              **
+*******************************************************************************/
+/**
+** \def The instrumentation of the parser : the statistics are collected in
+**      the ones of current_stats(), which are only set (for the calling
+**      thread) during parse(file, use_arena, stats). Without
+**      ENABLE_PARSE_STATS, the macros expand to nothing
+*/
+#ifdef ENABLE_PARSE_STATS
+/**
+** \returns The statistics collected by the calling thread, nullptr if it is
+**          not collecting any
+*/
+inline ParseStats *&current_stats()
+{
+    static thread_local ParseStats *stats = nullptr;
+    return stats;
+}
+
+/**
+** \returns The time of a monotonic clock, in nanoseconds
+*/
+inline uint_fast64_t stats_now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+#    define STATS_ADD(field, n)                                                \
+        do                                                                     \
+        {                                                                      \
+            ParseStats *stats_ = current_stats();                              \
+            if (stats_ != nullptr)                                             \
+            {                                                                  \
+                stats_->field += (n);                                          \
+            }                                                                  \
+        } while (0)
+
+#    define STATS_MAX(field, n)                                                \
+        do                                                                     \
+        {                                                                      \
+            ParseStats *stats_ = current_stats();                              \
+            if (stats_ != nullptr && stats_->field < (n))                      \
+            {                                                                  \
+                stats_->field = (n);                                           \
+            }                                                                  \
+        } while (0)
+
+// Counts a heap allocation of 'size' bytes
+#    define STATS_ALLOC(size)                                                  \
+        do                                                                     \
+        {                                                                      \
+            ParseStats *stats_ = current_stats();                              \
+            if (stats_ != nullptr)                                             \
+            {                                                                  \
+                ++stats_->nb_allocs;                                           \
+                stats_->alloc_bytes += (size);                                 \
+            }                                                                  \
+        } while (0)
+
+// Starts a timer named 'name', added to 'field' by STATS_STOP()
+#    define STATS_START(name)                                                  \
+        uint_fast64_t name = current_stats() == nullptr ? 0 : stats_now()
+
+#    define STATS_STOP(field, name) STATS_ADD(field, stats_now() - (name))
+#else
+#    define STATS_ADD(field, n)
+#    define STATS_MAX(field, n)
+#    define STATS_ALLOC(size)
+#    define STATS_START(name)
+#    define STATS_STOP(field, name)
+#endif
+
+#endif // !STATS_HPP
@@ -0,0 +1,348 @@
+#include "tape.hpp"
+
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <iostream>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "serializer.hpp"
+
+/*******************************************************************************
+**                                    TAPE                                    **
+*******************************************************************************/
+/**
+** \brief Creates an empty tape for an input of 'input_len' characters (0 if it
+**        is unknown). The decoded strings are never longer than their quoted
+**        characters in the input, so they all fit in the initial buffer
+*/
+Tape::Tape(uint_fast64_t input_len)
+    : words(nullptr)
+    , nb_words(0)
+    , words_capacity(0)
+    , chars(nullptr)
+    , nb_chars(0)
+    , chars_capacity(0)
+    , map(nullptr)
+    , map_size(0)
+{
+    // Most inputs have about one value every 8 characters
+    growWords(input_len / 4);
+    growChars(input_len + 1);
+}
+
+/**
+** \brief Creates a tape on words and characters that were written by another
+**        tape, in the given mapping, which is unmapped with the tape
+*/
+Tape::Tape(void *map, uint_fast64_t map_size, uint64_t *words,
+           uint_fast64_t nb_words, char *chars, uint_fast64_t nb_chars)
+    : words(words)
+    , nb_words(nb_words)
+    , words_capacity(nb_words)
+    , chars(chars)
+    , nb_chars(nb_chars)
+    , chars_capacity(nb_chars)
+    , map(map)
+    , map_size(map_size)
+{}
+
+Tape::~Tape()
+{
+    if (map != nullptr)
+    {
+        munmap(map, map_size);
+        return;
+    }
+    delete[] words;
+    delete[] chars;
+}
+
+/**
+** \brief Makes sure that 'n' words fit in the tape, by doubling its capacity
+*/
+void Tape::growWords(uint_fast64_t n)
+{
+    uint_fast64_t capacity =
+        words_capacity < BASE_TAPE_SIZE ? BASE_TAPE_SIZE : words_capacity * 2;
+    while (capacity < n)
+    {
+        capacity *= 2;
+    }
+
+    STATS_ALLOC(capacity * sizeof(uint64_t));
+    uint64_t *tmp = new uint64_t[capacity];
+    if (nb_words > 0)
+    {
+        std::memcpy(tmp, words, nb_words * sizeof(uint64_t));
+    }
+    delete[] words;
+    words = tmp;
+    words_capacity = capacity;
+}
+
+/**
+** \brief Makes sure that 'n' characters fit in the buffer of the strings, by
+**        doubling its capacity
+*/
+void Tape::growChars(uint_fast64_t n)
+{
+    uint_fast64_t capacity = chars_capacity < BASE_TAPE_SIZE
+        ? BASE_TAPE_SIZE
+        : chars_capacity * 2;
+    while (capacity < n)
+    {
+        capacity *= 2;
+    }
+
+    STATS_ALLOC(capacity);
+    char *tmp = new char[capacity];
+    if (nb_chars > 0)
+    {
+        std::memcpy(tmp, chars, nb_chars);
+    }
+    delete[] chars;
+    chars = tmp;
+    chars_capacity = capacity;
+}
+
+bool Tape::isArray()
+{
+    return TAPE_TAG(words[0]) == T_ARR;
+}
+
+TapeValue Tape::getRoot()
+{
+    return TapeValue(this, 0);
+}
+
+TapeArray Tape::getArray()
+{
+    return TapeArray(this, 0);
+}
+
+TapeDict Tape::getDict()
+{
+    return TapeDict(this, 0);
+}
+
+/**
+** \brief Prints the json object like JSON::print()
+*/
+void Tape::print(bool compact)
+{
+#ifndef VALGRING_DISABLE_PRINT
+    std::cout.flush();
+    if (compact)
+    {
+        Serializer serializer(false);
+        serializer.writeTape(this);
+        serializer.writeChar('\n');
+        serializer.writeTo(STDOUT_FILENO);
+    }
+    else
+    {
+        Serializer serializer(STDOUT_FILENO, true);
+        serializer.writeTape(this);
+        serializer.writeChar('\n');
+    }
+#else
+    (void)compact;
+#endif
+}
+
+/*******************************************************************************
+**                                   VIEWS                                    **
+*******************************************************************************/
+/**************************************
+**              VALUES               **
+**************************************/
+TapeValue::TapeValue(Tape *tape, uint_fast64_t pos)
+    : tape(tape)
+    , pos(pos)
+{}
+
+uint_fast64_t TapeValue::getPos()
+{
+    return pos;
+}
+
+/**
+** \returns The value that follows this one in its container (the word after
+**          its last one, which is the end of the container if this value is
+**          its last one)
+*/
+TapeValue TapeValue::getNext()
+{
+    uint64_t word = tape->getWords()[pos];
+    unsigned char tag = TAPE_TAG(word);
+    if (tag == T_ARR || tag == T_DICT)
+    {
+        return TapeValue(tape, TAPE_PAYLOAD(word) + 1);
+    }
+    return TapeValue(tape, pos + TAPE_NB_WORDS(tag));
+}
+
+unsigned char TapeValue::getType()
+{
+    return TAPE_TAG(tape->getWords()[pos]);
+}
+
+int_fast64_t TapeValue::getInt()
+{
+    return getType() == T_INT ? (int64_t)tape->getWords()[pos + 1] : 0;
+}
+
+double TapeValue::getDouble()
+{
+    if (getType() != T_DOUBLE)
+    {
+        return 0;
+    }
+
+    double d = 0;
+    std::memcpy(&d, tape->getWords() + pos + 1, sizeof(double));
+    return d;
+}
+
+bool TapeValue::getBool()
+{
+    uint64_t word = tape->getWords()[pos];
+    return TAPE_TAG(word) == T_BOOL && TAPE_PAYLOAD(word) != 0;
+}
+
+/**
+** \returns The characters of the string (not owned by the returned String,
+**          and null terminated), an empty string if the value is not a string
+*/
+String TapeValue::getString()
+{
+    uint64_t *words = tape->getWords();
+    if (TAPE_TAG(words[pos]) != T_STR)
+    {
+        return String("", 0, false);
+    }
+    return String(tape->getChars() + TAPE_PAYLOAD(words[pos]),
+                  words[pos + 1], false);
+}
+
+/**
+** \brief The value must be an array (see getType())
+*/
+TapeArray TapeValue::getArray()
+{
+    return TapeArray(tape, pos);
+}
+
+/**
+** \brief The value must be a dict (see getType())
+*/
+TapeDict TapeValue::getDict()
+{
+    return TapeDict(tape, pos);
+}
+
+/**************************************
+**               ITEMS               **
+**************************************/
+TapeItem::TapeItem(Tape *tape, uint_fast64_t pos)
+    : tape(tape)
+    , pos(pos)
+{}
+
+bool TapeItem::isValid()
+{
+    return tape != nullptr;
+}
+
+/**
+** \returns The item that follows this one in its dict (the end of the dict if
+**          this item is its last one)
+*/
+TapeItem TapeItem::getNext()
+{
+    return TapeItem(tape, getValue().getNext().getPos());
+}
+
+String TapeItem::getKey()
+{
+    return TapeValue(tape, pos).getString();
+}
+
+TapeValue TapeItem::getValue()
+{
+    return TapeValue(tape, pos + 2);
+}
+
+/**************************************
+**               ARRAY               **
+**************************************/
+TapeArray::TapeArray(Tape *tape, uint_fast64_t pos)
+    : tape(tape)
+    , pos(pos)
+{}
+
+uint_fast64_t TapeArray::getSize()
+{
+    return tape->getWords()[pos + 1];
+}
+
+/**
+** \returns The first value of the array (the end of the array if it is empty)
+*/
+TapeValue TapeArray::getFirst()
+{
+    return TapeValue(tape, pos + 2);
+}
+
+/**************************************
+**               DICT                **
+**************************************/
+TapeDict::TapeDict(Tape *tape, uint_fast64_t pos)
+    : tape(tape)
+    , pos(pos)
+{}
+
+uint_fast64_t TapeDict::getSize()
+{
+    return tape->getWords()[pos + 1];
+}
+
+/**
+** \returns The first item of the dict (the end of the dict if it is empty)
+*/
+TapeItem TapeDict::getFirst()
+{
+    return TapeItem(tape, pos + 2);
+}
+
+TapeItem TapeDict::getItem(String *key)
+{
+    return key == nullptr ? TapeItem(nullptr, 0)
+                          : getItem(key->str(), key->len());
+}
+
+/**
+** \returns The item of the given key, or an item that is not valid (see
+**          TapeItem::isValid()) if the dict does not contain the key
+*/
+TapeItem TapeDict::getItem(const char *key, uint_strlen_t len)
+{
+    if (key == nullptr)
+    {
+        return TapeItem(nullptr, 0);
+    }
+
+    TapeItem item = getFirst();
+    uint_fast64_t nb_items = getSize();
+    for (uint_fast64_t i = 0; i < nb_items; ++i, item = item.getNext())
+    {
+        String k = item.getKey();
+        if (k.len() == len && std::memcmp(k.str(), key, len) == 0)
+        {
+            return item;
+        }
+    }
+    return TapeItem(nullptr, 0);
+}
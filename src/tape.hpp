@@ -0,0 +1,263 @@
+#ifndef TAPE_HPP
+#define TAPE_HPP
+
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <cstring>
+#include <stdint.h>
+
+#include "json_types.hpp"
+#include "stats.hpp"
+
+/*******************************************************************************
+**                              DEFINES / MACROS                              **
+*******************************************************************************/
+/**
+** \def Each word of a tape has a tag in its 8 high bits (T_<TYPE>, or TAPE_END
+**      for the end of a container) and a payload in the 56 other bits
+*/
+#define TAPE_END 7
+#define TAPE_TAG_SHIFT 56
+#define TAPE_PAYLOAD_MASK ((UINT64_C(1) << TAPE_TAG_SHIFT) - 1)
+
+#define TAPE_WORD(tag, payload)                                                \
+    (((uint64_t)(tag) << TAPE_TAG_SHIFT) | (uint64_t)(payload))
+#define TAPE_TAG(word) ((unsigned char)((word) >> TAPE_TAG_SHIFT))
+#define TAPE_PAYLOAD(word) ((word) & TAPE_PAYLOAD_MASK)
+
+// Number of words of the values that have a second word
+#define TAPE_NB_WORDS(tag) ((tag) == T_BOOL || (tag) == T_NULL ? 1 : 2)
+
+// Minimum number of words of a tape, it is doubled each time it is full
+#define BASE_TAPE_SIZE 64
+
+/*******************************************************************************
+**                                   CLASSES                                  **
+*******************************************************************************/
+class Tape;
+class TapeArray;
+class TapeDict;
+
+/**
+** \class TapeValue Read-only view on a value of a tape, the equivalent of a
+**                  Value of a JSONArray or a JSONDict
+** \brief It is only a position in the tape, so it is copied by value and is
+**        valid as long as the tape
+** \param tape The tape
+** \param pos The position of the first word of the value
+*/
+class TapeValue
+{
+private:
+    Tape *tape;
+    uint_fast64_t pos;
+
+public:
+    TapeValue(Tape *tape, uint_fast64_t pos);
+
+    uint_fast64_t getPos();
+    TapeValue getNext();
+
+    unsigned char getType();
+    int_fast64_t getInt();
+    double getDouble();
+    bool getBool();
+    String getString();
+    TapeArray getArray();
+    TapeDict getDict();
+};
+
+/**
+** \class TapeItem Read-only view on an item of a TapeDict : a key and its value
+** \param tape The tape, nullptr if the item does not exist (see
+**             TapeDict::getItem())
+** \param pos The position of the first word of the key
+*/
+class TapeItem
+{
+private:
+    Tape *tape;
+    uint_fast64_t pos;
+
+public:
+    TapeItem(Tape *tape, uint_fast64_t pos);
+
+    bool isValid();
+    TapeItem getNext();
+
+    String getKey();
+    TapeValue getValue();
+};
+
+/**
+** \class TapeArray Read-only view on an array of a tape
+** \brief The values are not indexed, so there is no access by index like in a
+**        JSONArray : they are read in order with getFirst() and
+**        TapeValue::getNext(), which skips a value in O(1)
+** \param tape The tape
+** \param pos The position of the first word of the array
+*/
+class TapeArray
+{
+private:
+    Tape *tape;
+    uint_fast64_t pos;
+
+public:
+    TapeArray(Tape *tape, uint_fast64_t pos);
+
+    uint_fast64_t getSize();
+    TapeValue getFirst();
+};
+
+/**
+** \class TapeDict Read-only view on a dict of a tape, with the same accessors
+**                 as a JSONDict
+** \brief The keys are not indexed : getItem() compares them one after the
+**        other, skipping the values in O(1)
+** \param tape The tape
+** \param pos The position of the first word of the dict
+*/
+class TapeDict
+{
+private:
+    Tape *tape;
+    uint_fast64_t pos;
+
+public:
+    TapeDict(Tape *tape, uint_fast64_t pos);
+
+    uint_fast64_t getSize();
+    TapeItem getFirst();
+    TapeItem getItem(String *key);
+    TapeItem getItem(const char *key, uint_strlen_t len);
+};
+
+/**
+** \class Tape Flat representation of a json array or dict, an alternative to
+**             the tree of JSONArray and JSONDict
+** \brief The values are stored in the order of the input, in a single array of
+**        64 bits words, and the characters of the strings and keys one after
+**        the other in a single buffer (each one followed by a '\0'). The whole
+**        json object is then only two allocations, and reading it is a
+**        sequential access to these arrays.
+**        The words of each value are :
+**        - T_ARR or T_DICT : the position of the word that ends the container,
+**          then its number of values (or items)
+**        - TAPE_END : the position of the first word of the container it ends
+**        - T_STR : the position of the characters in the buffer, then their
+**          number (the keys of the dicts are stored the same way, before their
+**          value)
+**        - T_INT and T_DOUBLE : the tag, then the bits of the number
+**        - T_BOOL : the value in the payload
+**        - T_NULL : only the tag
+**        So any value can be skipped in O(1). The tape is read through the
+**        views TapeArray, TapeDict and TapeValue, it can't be modified.
+**        The words and characters only contain positions and no pointers, so
+**        they can also be written to a file and mapped back in memory as is
+**        (see snapshot.hpp), in which case the tape doesn't own them
+** \param words The words of the values, the first one being the root
+** \param nb_words The number of words
+** \param words_capacity The number of words that fit in 'words'
+** \param chars The characters of the strings and keys
+** \param nb_chars The number of characters
+** \param chars_capacity The number of characters that fit in 'chars'
+** \param map The mapping that contains the words and characters, nullptr if
+**            they are allocated by the tape
+** \param map_size The size of the mapping
+*/
+class Tape
+{
+private:
+    uint64_t *words;
+    uint_fast64_t nb_words;
+    uint_fast64_t words_capacity;
+    char *chars;
+    uint_fast64_t nb_chars;
+    uint_fast64_t chars_capacity;
+    void *map;
+    uint_fast64_t map_size;
+
+    void growWords(uint_fast64_t n);
+    void growChars(uint_fast64_t n);
+
+public:
+    Tape(uint_fast64_t input_len);
+    Tape(void *map, uint_fast64_t map_size, uint64_t *words,
+         uint_fast64_t nb_words, char *chars, uint_fast64_t nb_chars);
+    ~Tape();
+
+    /**
+    ** \brief Adds a word at the end of the tape
+    */
+    void addWord(uint64_t word)
+    {
+        if (nb_words == words_capacity)
+        {
+            growWords(nb_words + 1);
+        }
+        words[nb_words++] = word;
+    }
+
+    /**
+    ** \brief Adds a value that takes two words
+    */
+    void addWords(uint64_t word, uint64_t second)
+    {
+        if (words_capacity - nb_words < 2)
+        {
+            growWords(nb_words + 2);
+        }
+        words[nb_words] = word;
+        words[nb_words + 1] = second;
+        nb_words += 2;
+    }
+
+    /**
+    ** \brief Copies the given characters at the end of the buffer of the
+    **        strings, followed by a '\0'
+    ** \returns Their position in the buffer
+    */
+    uint_fast64_t addChars(const char *str, uint_fast64_t len)
+    {
+        if (chars_capacity - nb_chars <= len)
+        {
+            growChars(nb_chars + len + 1);
+        }
+        uint_fast64_t start = nb_chars;
+        std::memcpy(chars + start, str, len);
+        chars[start + len] = 0;
+        nb_chars += len + 1;
+        return start;
+    }
+
+    uint64_t *getWords()
+    {
+        return words;
+    }
+
+    uint_fast64_t getNbWords()
+    {
+        return nb_words;
+    }
+
+    const char *getChars()
+    {
+        return chars;
+    }
+
+    uint_fast64_t getNbChars()
+    {
+        return nb_chars;
+    }
+
+    bool isArray();
+    TapeValue getRoot();
+    TapeArray getArray();
+    TapeDict getDict();
+
+    void print(bool compact = false);
+};
+
+#endif // !TAPE_HPP
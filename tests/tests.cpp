@@ -0,0 +1,813 @@
+/*******************************************************************************
+**                                  INCLUDES                                  **
+*******************************************************************************/
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <random>
+#include <string>
+#include <unistd.h>
+
+#include "../src/cursor.hpp"
+#include "../src/handler.hpp"
+#include "../src/ndjson.hpp"
+#include "../src/number.hpp"
+#include "../src/parser.hpp"
+#include "../src/path.hpp"
+#include "../src/serializer.hpp"
+#include "../src/snapshot.hpp"
+
+/*******************************************************************************
+**                              DEFINES / MACROS                              **
+*******************************************************************************/
+/**
+** \def Counts the check, and prints it if it fails
+*/
+#define CHECK(cond, input)                                                     \
+    do                                                                         \
+    {                                                                          \
+        ++nb_checks;                                                           \
+        if (!(cond))                                                           \
+        {                                                                      \
+            ++nb_failed;                                                       \
+            printf("FAILED %s:%d : %s, input '%s'\n", __FILE__, __LINE__,      \
+                   #cond, input);                                              \
+        }                                                                      \
+    } while (0)
+
+/*******************************************************************************
+**                                  GLOBALS                                   **
+*******************************************************************************/
+static uint_fast64_t nb_checks = 0;
+static uint_fast64_t nb_failed = 0;
+
+// Documents that are not valid json, but start with a valid array or dict
+static const char *const invalid_docs[] = {
+    "[1 2]",         "[1,,2]",          "[1,]",         "[,1]",
+    "[,]",           "{\"a\" 1}",       "{\"a\"::1}",   "{\"a\":1,}",
+    "{,\"a\":1}",    "{\"a\":}",        "{:1}",         "{\"a\":1 \"b\":2}",
+    "[\"a\":1]",     "[\"a\" \"b\"]",   "[[1][2]]",     "[{} {}]",
+    "[true false]",  "[null\"a\"]",     "[1\"a\"]",     "[1]]",
+    "[1]x",          "[1] [2]",         "[1]:",         "{\"a\":1},",
+    "[1,2,3]4",      "{\"a\":1}{\"b\":2}",
+    // Characters after a number or a literal (the structural index only has
+    // the first character of these values)
+    "[1x]",          "[truex]",         "[1.5.5]",      "[-1.5e3abc]",
+    "{\"a\":1x}",    "[nullnull]",      "[falsefalse]", "[1-]",
+    "{\"a\":nullx}", "[0x10]",          "[1\"a\"]",     "[true[]]",
+    "[null{}]",      "[1 x]",
+};
+
+// Valid documents, printed compactly by the parser
+static const char *const valid_docs[] = {
+    "[]",
+    "{}",
+    "[1,2,3]",
+    "{\"a\":1,\"b\":[true,false,null],\"c\":{\"d\":\"e\"}}",
+    "[[],{},[[]],{\"a\":{}}]",
+    "[-1.5,\"x\",null]",
+    "[1,[2,[3,[4]]],{\"a\":[{\"b\":1}]}]",
+};
+
+// Numbers that are read as doubles, which must be the ones strtod() reads :
+// the value that used to be printed as 1024, the limits of Clinger's fast
+// path (2^53 and 1e22), the largest and smallest doubles, the subnormals and
+// their rounding to 0, -0 and the integers that overflow an int64_t
+static const char *const doubles[] = {
+    "2e10",
+    "0.1",
+    "-1.5e3",
+    "0.30000000000000004",
+    "3.141592653589793238462643383279",
+    "9007199254740992.0",
+    "9007199254740993.0",
+    "9007199254740995.0",
+    "-9007199254740993e0",
+    "18014398509481985.0",
+    "1e22",
+    "1e23",
+    "9.999999999999999e22",
+    "1.0000000000000001e22",
+    "4.5035996273704985e15",
+    "1.7976931348623157e308",
+    "1.7976931348623158e308",
+    "2.2250738585072014e-308",
+    "2.2250738585072011e-308",
+    "4.9406564584124654e-324",
+    "5e-324",
+    "2.4703282292062328e-324",
+    "2.4703282292062327e-324",
+    "1e-400",
+    "-0.0",
+    "-0e5",
+    "0.0",
+    "9223372036854775808",
+    "-9223372036854775809",
+    "18446744073709551616",
+    "123456789012345678901234567890",
+};
+
+/*******************************************************************************
+**                                   CLASSES                                  **
+*******************************************************************************/
+/**
+** \class Recorder Handler that writes the events it receives in a string
+** \param events The events, separated by spaces
+** \param nb_left The number of events after which the handler stops the
+**                parsing, or -1
+*/
+class Recorder final : public Handler
+{
+public:
+    std::string events;
+    int nb_left = -1;
+
+    bool add(const std::string &event)
+    {
+        events += events.empty() ? event : " " + event;
+        return nb_left < 0 || --nb_left > 0;
+    }
+
+    bool onStartArray() override
+    {
+        return add("[");
+    }
+
+    bool onEndArray() override
+    {
+        return add("]");
+    }
+
+    bool onStartObject() override
+    {
+        return add("{");
+    }
+
+    bool onEndObject() override
+    {
+        return add("}");
+    }
+
+    bool onKey(const char *str, uint_fast64_t len, bool) override
+    {
+        return add("k:" + std::string(str, len));
+    }
+
+    bool onString(const char *str, uint_fast64_t len, bool) override
+    {
+        return add("s:" + std::string(str, len));
+    }
+
+    bool onInt(int_fast64_t i) override
+    {
+        return add("i:" + std::to_string(i));
+    }
+
+    bool onDouble(double d) override
+    {
+        return add("d:" + std::to_string(d));
+    }
+
+    bool onBool(bool b) override
+    {
+        return add(b ? "true" : "false");
+    }
+
+    bool onNull() override
+    {
+        return add("null");
+    }
+};
+
+/*******************************************************************************
+**                              LOCAL FUNCTIONS                               **
+*******************************************************************************/
+/**
+** \brief Writes the given characters in a new temporary file
+** \param path The template of the path of the file, set to its path
+*/
+static void write_file(char *path, const std::string &s)
+{
+    int fd = mkstemp(path);
+    FILE *f = fdopen(fd, "w");
+    fwrite(s.data(), 1, s.size(), f);
+    fclose(f);
+}
+
+/**
+** \returns Whether a Cursor reads the whole input without error
+*/
+static bool cursor_accepts(const char *s)
+{
+    Cursor c(s, strlen(s));
+    unsigned char token = TOKEN_END;
+    do
+    {
+        token = c.next();
+    } while (token != TOKEN_END && token != TOKEN_ERROR);
+    return token == TOKEN_END;
+}
+
+/**
+** \returns The compact printing of the json object of the given document, or
+**          "null" if it is nullptr
+*/
+static std::string to_string(Document *doc)
+{
+    if (doc == nullptr)
+    {
+        return "null";
+    }
+    Serializer s(false);
+    s.writeJSON(doc->getRoot());
+    return std::string(s.getData(), s.getSize());
+}
+
+/**
+** \brief Checks that the documents that are not valid json are rejected by
+**        every way of parsing them
+*/
+static void test_invalid()
+{
+    char path[] = "/tmp/json-tests-XXXXXX";
+    for (const char *s : invalid_docs)
+    {
+        uint_fast64_t len = strlen(s);
+        JSON *j = parse_buffer(s, len);
+        CHECK(j == nullptr, s);
+        delete j;
+
+        Document *doc = parse_buffer(s, len, true);
+        CHECK(doc == nullptr, s);
+        delete doc;
+
+        Tape *t = parse_tape(s, len);
+        CHECK(t == nullptr, s);
+        delete t;
+
+        CHECK(!cursor_accepts(s), s);
+
+        std::strcpy(path, "/tmp/json-tests-XXXXXX");
+        write_file(path, s);
+        doc = parse(path, false);
+        CHECK(doc == nullptr, s);
+        delete doc;
+        doc = parse_parallel(path, true, 2);
+        CHECK(doc == nullptr, s);
+        delete doc;
+        doc = parse_lazy(path, true);
+        CHECK(doc == nullptr, s);
+        delete doc;
+        unlink(path);
+    }
+}
+
+/**
+** \brief Checks that the valid documents are parsed by every way of parsing
+**        them, with the whitespaces that can surround their tokens
+*/
+static void test_valid()
+{
+    char path[] = "/tmp/json-tests-XXXXXX";
+    for (const char *s : valid_docs)
+    {
+        Document *doc = parse_buffer(s, strlen(s), false);
+        CHECK(to_string(doc) == s, s);
+        delete doc;
+
+        // The same document with whitespaces between all its tokens
+        std::string spaced = " \n";
+        for (const char *c = s; *c; ++c)
+        {
+            spaced += *c;
+            if (*c == ',' || *c == ':' || *c == '[' || *c == '{'
+                || c[1] == ']' || c[1] == '}')
+            {
+                spaced += " \t\r\n";
+            }
+        }
+        spaced += "\n\n";
+        const char *sp = spaced.c_str();
+        doc = parse_buffer(sp, spaced.size(), true);
+        CHECK(to_string(doc) == s, sp);
+        delete doc;
+
+        Tape *t = parse_tape(sp, spaced.size());
+        CHECK(t != nullptr, sp);
+        delete t;
+
+        CHECK(cursor_accepts(sp), sp);
+
+        std::strcpy(path, "/tmp/json-tests-XXXXXX");
+        write_file(path, spaced);
+        doc = parse(path, false);
+        CHECK(to_string(doc) == s, sp);
+        delete doc;
+        doc = parse_parallel(path, true, 2);
+        CHECK(to_string(doc) == s, sp);
+        delete doc;
+        doc = parse_lazy(path, false);
+        CHECK(to_string(doc) == s, sp);
+        delete doc;
+        unlink(path);
+    }
+}
+
+/**
+** \brief Checks that the arrays that are parsed in parallel are rejected when
+**        their separators are wrong, in any part
+*/
+static void test_parallel()
+{
+    // Large enough to be cut in several parts
+    std::string elements;
+    for (int i = 0; i < 100000; ++i)
+    {
+        elements += std::to_string(i) + ", ";
+    }
+
+    static const char *const tails[] = { "1]", "1,]", "1 2]", "1]]", "1],",
+                                         ",1]" };
+    static const bool valid[] = { true, false, false, false, false, false };
+    char path[] = "/tmp/json-tests-XXXXXX";
+    for (int i = 0; i < 6; ++i)
+    {
+        std::strcpy(path, "/tmp/json-tests-XXXXXX");
+        write_file(path, "[" + elements + tails[i]);
+        Document *doc = parse_parallel(path, true, 4);
+        CHECK((doc != nullptr) == valid[i], tails[i]);
+        delete doc;
+        unlink(path);
+    }
+}
+
+/**
+** \returns Whether both doubles have the same bits (so -0.0 is not 0.0)
+*/
+static bool same_double(double a, double b)
+{
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+/**
+** \brief Checks that write_double() writes the double so that it is read back
+**        as the same double, by strtod() and by read_number()
+*/
+static void check_write_double(double d)
+{
+    char buff[NUMBER_BUFF_SIZE + 1];
+    uint_fast8_t len = write_double(d, buff);
+    buff[len] = 0;
+    Number n;
+    CHECK(same_double(strtod(buff, nullptr), d), buff);
+    CHECK(read_number(buff, len, &n) == len && n.is_float
+              && same_double(n.d, d),
+          buff);
+}
+
+/**
+** \brief Checks that the numbers are read with the right type and correctly
+**        rounded, and that the doubles are written so that they are read back
+**        as themselves
+*/
+static void test_numbers()
+{
+    Number n;
+    for (const char *s : doubles)
+    {
+        uint_fast64_t len = strlen(s);
+        CHECK(read_number(s, len, &n) == len && n.is_float
+                  && same_double(n.d, strtod(s, nullptr)),
+              s);
+        check_write_double(strtod(s, nullptr));
+    }
+
+    static const char *const ints[] = { "0", "-0", "9223372036854775807",
+                                        "-9223372036854775808",
+                                        "9007199254740993" };
+    static const int64_t values[] = { 0, 0, INT64_MAX, INT64_MIN,
+                                      INT64_C(9007199254740993) };
+    for (int i = 0; i < 5; ++i)
+    {
+        uint_fast64_t len = strlen(ints[i]);
+        CHECK(read_number(ints[i], len, &n) == len && !n.is_float
+                  && n.i == values[i],
+              ints[i]);
+    }
+
+    static const double written[] = { 2e10, -0.0, 1e22, 5e-324,
+                                      std::numeric_limits<double>::max() };
+    static const char *const texts[] = { "20000000000.0", "-0.0", "1e+22",
+                                         "5e-324", "1.7976931348623157e+308" };
+    for (int i = 0; i < 5; ++i)
+    {
+        char buff[NUMBER_BUFF_SIZE];
+        uint_fast8_t len = write_double(written[i], buff);
+        CHECK(std::string(buff, len) == texts[i], texts[i]);
+    }
+
+    const char *s = "[2e10,-0.0,1e22,9223372036854775808]";
+    Document *doc = parse_buffer(s, strlen(s), true);
+    CHECK(to_string(doc)
+              == "[20000000000.0,-0.0,1e+22,9.223372036854776e+18]",
+          s);
+    delete doc;
+
+    check_write_double(std::numeric_limits<double>::min());
+    check_write_double(std::numeric_limits<double>::denorm_min());
+    check_write_double(-std::numeric_limits<double>::max());
+    // Any finite double
+    std::mt19937_64 rng(42);
+    for (int i = 0; i < 100000; ++i)
+    {
+        uint64_t bits = rng();
+        double d = 0;
+        std::memcpy(&d, &bits, sizeof(double));
+        if (std::isfinite(d))
+        {
+            check_write_double(d);
+        }
+    }
+}
+
+/**
+** \brief Checks that the paths find the values they designate, with and
+**        without arena, and nothing when they are not well formed or their
+**        values don't exist
+*/
+static void test_path()
+{
+    const char *s = "{\"a/b\":1,\"m~n\":2,\"\":3,\"arr\":[10,20],"
+                    "\"x\":{\"\":4,\"y\":[{\"z\":5}]}}";
+    static const char *const found[] = { "/a~1b", "/m~0n", "/",  "/arr/0",
+                                         "/arr/1", "/x/",  "/x/y/0/z",
+                                         "arr.1", "x.y.0.z" };
+    static const int64_t values[] = { 1, 2, 3, 10, 20, 4, 5, 20, 5 };
+    static const char *const missing[] = {
+        "/m~2n", "/a~",   "/a/b",    "/arr/01", "/arr/2",
+        "/arr/-1", "/arr/", "/arr/1/0", "/y",     "arr.2",
+    };
+    for (int use_arena = 0; use_arena < 2; ++use_arena)
+    {
+        Document *doc = parse_buffer(s, strlen(s), use_arena == 1);
+        JSON *root = doc->getRoot();
+        Value v;
+        for (int i = 0; i < 9; ++i)
+        {
+            CHECK(query(root, found[i], &v) && v.getType() == T_INT
+                      && v.getInt() == values[i],
+                  found[i]);
+        }
+        for (const char *path : missing)
+        {
+            CHECK(!query(root, path, &v), path);
+        }
+        CHECK(query(root, "", &v) && v.getDict() == root, s);
+        delete doc;
+    }
+
+    // '~' is only followed by '0' or '1' in a JSON Pointer
+    Path bad("/m~2n");
+    CHECK(!bad.isValid(), "/m~2n");
+    Path good("/m~0n/a~1b");
+    CHECK(good.isValid() && good.getNbSteps() == 2, "/m~0n/a~1b");
+}
+
+/**
+** \brief Checks that the nested containers of a lazy document are parsed when
+**        they are first accessed, and are nullptr if their content is invalid
+**        (only their brackets are checked by parse_lazy())
+*/
+static void test_lazy()
+{
+    char path[] = "/tmp/json-tests-XXXXXX";
+    write_file(path, "{\"a\":[1,{\"b\":[2]}],\"bad\":[1,,2],\"s\":\"]\","
+                     "\"bad_dict\":{\"k\" 1},\"c\":{\"d\":\"e\"}}");
+    for (int use_arena = 0; use_arena < 2; ++use_arena)
+    {
+        Document *doc = parse_lazy(path, use_arena == 1);
+        CHECK(doc != nullptr, path);
+        if (doc == nullptr)
+        {
+            continue;
+        }
+        JSONDict *root = (JSONDict *)doc->getRoot();
+
+        Value *v = root->getItem("a", 1)->getValue();
+        CHECK(v->isLazy() && v->getType() == T_ARR, "a");
+        JSONArray *a = v->getArray();
+        CHECK(a != nullptr && a->getSize() == 2 && v->getArray() == a, "a");
+        // The containers of a lazy container are lazy too
+        Value *inner = a == nullptr ? nullptr : a->getValueAt(1);
+        CHECK(inner != nullptr && inner->isLazy(), "a/1");
+        JSONDict *jd = inner == nullptr ? nullptr : inner->getDict();
+        Item *it = jd == nullptr ? nullptr : jd->getItem("b", 1);
+        JSONArray *b = it == nullptr ? nullptr : it->getValue()->getArray();
+        CHECK(b != nullptr && b->getValueAt(0)->getInt() == 2, "a/1/b/0");
+
+        v = root->getItem("bad", 3)->getValue();
+        CHECK(v->isLazy() && v->getArray() == nullptr, "bad");
+        CHECK(v->getArray() == nullptr, "bad");
+        v = root->getItem("bad_dict", 8)->getValue();
+        CHECK(v->isLazy() && v->getDict() == nullptr, "bad_dict");
+        v = root->getItem("s", 1)->getValue();
+        CHECK(v->getType() == T_STR && v->getString()->len() == 1, "s");
+        jd = root->getItem("c", 1)->getValue()->getDict();
+        CHECK(jd != nullptr && jd->getItem("d", 1) != nullptr, "c");
+        delete doc;
+    }
+    unlink(path);
+}
+
+/**
+** \brief Checks the order of the events given to a handler, from a buffer and
+**        from a file, and that the parsing ends when the handler stops it
+*/
+static void test_handler()
+{
+    const char *s = "{\"a\":[1,\"x\\ny\",true,null,1.5],\"b\":{},\"c\":false}";
+    const char *expected = "{ k:a [ i:1 s:x\ny true null d:1.500000 ] k:b { } "
+                           "k:c false }";
+    char path[] = "/tmp/json-tests-XXXXXX";
+    write_file(path, s);
+
+    Recorder all;
+    uint_fast16_t err = 0;
+    CHECK(parse_buffer(s, strlen(s), &all, &err) && err == 0, s);
+    CHECK(all.events == expected, all.events.c_str());
+    Recorder from_file;
+    CHECK(parse(path, &from_file, &err) && err == 0, path);
+    CHECK(from_file.events == expected, from_file.events.c_str());
+
+    // Stopped at the third event, which is the first value of the array
+    Recorder stopped;
+    stopped.nb_left = 3;
+    CHECK(!parse_buffer(s, strlen(s), &stopped, &err)
+              && err == ERR_HANDLER_STOPPED,
+          s);
+    CHECK(stopped.events == "{ k:a [", stopped.events.c_str());
+    Recorder stopped_file;
+    stopped_file.nb_left = 5;
+    CHECK(!parse(path, &stopped_file, &err) && err == ERR_HANDLER_STOPPED,
+          path);
+    CHECK(stopped_file.events == "{ k:a [ i:1 s:x\ny",
+          stopped_file.events.c_str());
+    unlink(path);
+
+    // The events before the error are given, the error is not a stop
+    const char *invalid = "[1,2 3]";
+    Recorder partial;
+    CHECK(!parse_buffer(invalid, strlen(invalid), &partial, &err)
+              && (err & ERR_INVALID_JSON) && !(err & ERR_HANDLER_STOPPED),
+          invalid);
+    CHECK(partial.events == "[ i:1 i:2", partial.events.c_str());
+}
+
+/**
+** \brief Checks that Cursor::skip() moves past whole containers, with brackets
+**        and escaped quotes in their strings, from a buffer and from a file
+**        (indexed or not, depending on the build)
+*/
+static void test_skip()
+{
+    const char *s = "{\"a\":[1,[\"]\",{\"}\":\"[\\\"]\\\\\"}],[]],\"b\":2,"
+                    "\"c\":{\"d\":{\"e\":[\"{\"]}},\"f\":\"x\"}";
+    char path[] = "/tmp/json-tests-XXXXXX";
+    write_file(path, s);
+    for (int from_file = 0; from_file < 2; ++from_file)
+    {
+        Cursor c(s, strlen(s));
+        Cursor f(path);
+        Cursor *cur = from_file ? &f : &c;
+        CHECK(cur->next() == TOKEN_START_DICT, s);
+        CHECK(cur->next() == TOKEN_START_ARRAY && cur->getKeyLen() == 1
+                  && cur->getKey()[0] == 'a',
+              s);
+        CHECK(cur->skip() && cur->getToken() == TOKEN_END_ARRAY
+                  && cur->getDepth() == 1,
+              s);
+        CHECK(cur->next() == TOKEN_INT && cur->getKey()[0] == 'b'
+                  && cur->getInt() == 2,
+              s);
+        // Skipping a scalar does nothing
+        CHECK(cur->skip() && cur->getToken() == TOKEN_INT, s);
+        CHECK(cur->next() == TOKEN_START_DICT && cur->getKey()[0] == 'c', s);
+        CHECK(cur->skip() && cur->getToken() == TOKEN_END_DICT, s);
+        CHECK(cur->next() == TOKEN_STR && cur->getKey()[0] == 'f'
+                  && cur->getStrLen() == 1 && cur->getStr()[0] == 'x',
+              s);
+        CHECK(cur->next() == TOKEN_END_DICT, s);
+        CHECK(cur->next() == TOKEN_END, s);
+    }
+    unlink(path);
+
+    // The root itself, then what follows it is still checked
+    const char *root = "[[1],\"]\",{\"a\":\"\\\\\"}] ";
+    Cursor c(root, strlen(root));
+    CHECK(c.next() == TOKEN_START_ARRAY && c.skip(), root);
+    CHECK(c.getDepth() == 0 && c.next() == TOKEN_END, root);
+    const char *trailing = "[[1]] x";
+    Cursor t(trailing, strlen(trailing));
+    CHECK(t.next() == TOKEN_START_ARRAY && t.skip(), trailing);
+    CHECK(t.next() == TOKEN_ERROR, trailing);
+
+    // The input ends before the end of the container
+    const char *unterminated = "[1,[2,\"]\"";
+    Cursor u(unterminated, strlen(unterminated));
+    CHECK(u.next() == TOKEN_START_ARRAY && u.next() == TOKEN_INT, unterminated);
+    CHECK(u.next() == TOKEN_START_ARRAY && !u.skip(), unterminated);
+    CHECK(u.getToken() == TOKEN_ERROR && u.next() == TOKEN_ERROR, unterminated);
+}
+
+/**
+** \brief Checks that a Parser that is reused for files of growing and
+**        shrinking sizes gives the json object of each one
+*/
+static void test_parser()
+{
+    Parser parser;
+    static const int sizes[] = { 10, 100000, 1000, 300000, 5 };
+    for (int size : sizes)
+    {
+        std::string s = "[";
+        for (int i = 0; i < size; ++i)
+        {
+            s += (i == 0 ? "\"" : ",\"") + std::to_string(i) + "\"";
+        }
+        s += "]";
+        char path[] = "/tmp/json-tests-XXXXXX";
+        write_file(path, s);
+        JSON *j = parser.parse(path);
+        uint_fast64_t n = size;
+        CHECK(j != nullptr && ((JSONArray *)j)->getSize() == n, path);
+        if (j != nullptr)
+        {
+            Serializer ser(false);
+            ser.writeJSON(j);
+            CHECK(std::string(ser.getData(), ser.getSize()) == s, path);
+        }
+        unlink(path);
+    }
+}
+
+/**
+** \brief Checks that the buffer functions are called with lengths of any
+**        integer type, and with non-const characters
+*/
+static void test_buffer()
+{
+    char chars[] = "[1]";
+    int len = 3;
+    std::size_t size = 3;
+
+    JSON *j = parse_buffer("[1]", 3);
+    CHECK(j != nullptr, "[1]");
+    delete j;
+    j = parse_buffer(chars, len);
+    CHECK(j != nullptr, chars);
+    delete j;
+
+    Document *doc = parse_buffer(chars, size, true);
+    CHECK(to_string(doc) == "[1]", chars);
+    delete doc;
+    doc = parse_buffer("[1]", 3, false);
+    CHECK(to_string(doc) == "[1]", "[1]");
+    delete doc;
+}
+
+/**
+** \brief Checks that the snapshots whose header is valid but whose words are
+**        not are not loaded, and that the file is parsed again instead
+*/
+static void test_snapshot()
+{
+    // Words : 0 dict, 2 "a", 4 array, 6 1, 8 "bc", 10 end of the array,
+    // 11 "d", 13 null, 14 end of the dict
+    char path[] = "/tmp/json-tests-XXXXXX";
+    write_file(path, "{\"a\":[1,\"bc\"],\"d\":null}");
+    std::string snapshot = std::string(path) + ".snapshot";
+    char *snap = (char *)snapshot.c_str();
+    Tape *t = parse_cached(path, snap);
+    CHECK(t != nullptr && t->getNbWords() == 15, snap);
+    delete t;
+    t = load_snapshot(path, snap);
+    CHECK(t != nullptr, snap);
+    delete t;
+
+    static const uint_fast64_t positions[] = { 9, 5, 4, 10, 2, 11, 1, 8 };
+    static const uint64_t corrupted[] = {
+        1000,                         // The characters are out of the buffer
+        3,                            // The array has 2 values
+        TAPE_WORD(T_ARR, 9),          // The array ends at 10
+        TAPE_WORD(TAPE_END, 2),       // The array starts at 4
+        TAPE_WORD(T_NULL, 0),         // A key is not a string
+        TAPE_WORD(TAPE_END + 1, 0),   // Unknown tag
+        UINT64_C(1) << 60,            // The dict has 2 items
+        TAPE_WORD(T_STR, 1000),       // The characters are out of the buffer
+    };
+    for (int i = 0; i < 8; ++i)
+    {
+        int fd = open(snap, O_WRONLY);
+        ssize_t n = pwrite(fd, &corrupted[i], sizeof(uint64_t),
+                           sizeof(SnapshotHeader)
+                               + positions[i] * sizeof(uint64_t));
+        close(fd);
+        CHECK(n == sizeof(uint64_t), snap);
+
+        t = load_snapshot(path, snap);
+        CHECK(t == nullptr, snap);
+        delete t;
+        // The file is parsed, and its snapshot written again
+        t = parse_cached(path, snap);
+        CHECK(t != nullptr && t->getNbWords() == 15, snap);
+        delete t;
+        t = load_snapshot(path, snap);
+        CHECK(t != nullptr, snap);
+        delete t;
+    }
+    unlink(snap);
+    unlink(path);
+}
+
+/**
+** \brief Checks that the keys added to a parsed dict are compared with its
+**        keys by their characters, even if they are other Strings than the
+**        interned ones
+*/
+static void test_add_item()
+{
+    const char *s = "{\"a\":1,\"b\":2}";
+    Document *doc = parse_buffer(s, strlen(s), true);
+    JSONDict *jd = (JSONDict *)doc->getRoot();
+    String a("a", 1, false);
+    String c("c", 1, false);
+    String other_c("c", 1, false);
+    CHECK(jd->addItem(&a, Value::fromInt(3)) == ERR_ITEM_EXISTS, s);
+    CHECK(jd->addItem(&c, Value::fromInt(3)) == 0, s);
+    CHECK(jd->addItem(&other_c, Value::fromInt(4)) == ERR_ITEM_EXISTS, s);
+    CHECK(jd->getSize() == 3, s);
+
+    Item *it = jd->getItem("c", 1);
+    CHECK(it != nullptr && it->getValue()->getInt() == 3, s);
+    CHECK(jd->getItem(&other_c) == it, s);
+    it = jd->getItem("a", 1);
+    CHECK(it != nullptr && it->getValue()->getInt() == 1, s);
+    delete doc;
+}
+
+/**
+** \brief Checks that a line of a newline-delimited json file that contains
+**        several documents is reported as invalid
+*/
+static void test_ndjson()
+{
+    char path[] = "/tmp/json-tests-XXXXXX";
+    write_file(path, "{\"a\":1}\n{\"a\":1}{\"b\":2}\n[1] \n");
+    NDJSONReader reader(path, true);
+    static const bool valid[] = { true, false, true };
+    Document *doc = nullptr;
+    for (int i = 0; i < 3; ++i)
+    {
+        CHECK(reader.next(&doc), path);
+        CHECK((doc != nullptr) == valid[i], path);
+        delete doc;
+    }
+    CHECK(!reader.next(&doc), path);
+    unlink(path);
+}
+
+/*******************************************************************************
+**                                    MAIN                                    **
+*******************************************************************************/
+/**
+** \brief Runs the tests, which are built with and without the structural index
+**        (see the 'test' rule of the Makefile)
+*/
+int main()
+{
+    test_invalid();
+    test_valid();
+    test_parallel();
+    test_numbers();
+    test_path();
+    test_lazy();
+    test_handler();
+    test_skip();
+    test_parser();
+    test_buffer();
+    test_snapshot();
+    test_add_item();
+    test_ndjson();
+
+#ifdef DISABLE_STRUCTURAL_INDEX
+    const char *name = "without structural index";
+#else
+    const char *name = "with structural index";
+#endif
+    printf("%s : %lu checks, %lu failed\n", name, (unsigned long)nb_checks,
+           (unsigned long)nb_failed);
+    return nb_failed != 0;
+}